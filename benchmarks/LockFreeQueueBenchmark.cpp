@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <LockFreeQueue.hpp>
+#include <file_io.hpp>
+
+// Producer/consumer throughput and hand-off latency of LockFreeQueue for the different layouts, capacities and payload sizes.
+// Usage: LockFreeQueueBenchmark [nItems] (build with -DCMAKE_BUILD_TYPE=Release, otherwise the numbers are meaningless)
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Payload64 {
+    std::array<std::uint8_t, 64> bytes{};
+};
+
+template<typename T>
+T makePayload(std::size_t i) {
+    if constexpr (std::is_same_v<T, file::FileData>) {
+        return file::FileData{.requestID = i, .name = "sample.bin", .data = std::vector<std::uint8_t>(256UZ, static_cast<std::uint8_t>(i))};
+    } else if constexpr (std::is_same_v<T, Payload64>) {
+        Payload64 payload;
+        payload.bytes[0] = static_cast<std::uint8_t>(i);
+        return payload;
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+template<typename T>
+constexpr std::string_view payloadName() {
+    if constexpr (std::is_same_v<T, file::FileData>) {
+        return "FileData(256 B)";
+    } else if constexpr (std::is_same_v<T, Payload64>) {
+        return "64 B struct";
+    } else {
+        return "int";
+    }
+}
+
+template<typename Queue>
+double measureThroughput(std::size_t nItems) {
+    using T = std::remove_cvref_t<decltype(*std::declval<Queue&>().pop_front())>;
+    auto queue = std::make_unique<Queue>();
+
+    std::vector<T> payloads; // pre-built outside of the timed region
+    payloads.reserve(1024UZ);
+    for (std::size_t i = 0UZ; i < 1024UZ; ++i) {
+        payloads.push_back(makePayload<T>(i));
+    }
+
+    std::atomic<bool> go{false};
+    std::thread       producer([&] {
+        while (!go.load(std::memory_order_acquire)) {
+        }
+        for (std::size_t i = 0UZ; i < nItems; ++i) {
+            while (!queue->push_back(payloads[i & 1023UZ])) {
+                std::this_thread::yield(); // full
+            }
+        }
+    });
+
+    go.store(true, std::memory_order_release);
+    const auto  start    = Clock::now();
+    std::size_t received = 0UZ;
+    while (received < nItems) {
+        if (auto item = queue->pop_front()) {
+            ++received;
+        } else {
+            std::this_thread::yield(); // empty
+        }
+    }
+    const auto stop = Clock::now();
+    producer.join();
+    return static_cast<double>(nItems) / std::chrono::duration<double>(stop - start).count();
+}
+
+template<typename Queue>
+std::pair<double, double> measureLatency(std::size_t nItems) {
+    using T = std::remove_cvref_t<decltype(*std::declval<Queue&>().pop_front())>;
+    auto queue = std::make_unique<Queue>();
+
+    // push time-stamps are published through the queue's release/acquire pair together with the payload
+    std::vector<Clock::time_point> pushTime(nItems);
+    std::vector<std::int64_t>      latency(nItems);
+    const T                        payload = makePayload<T>(0UZ);
+
+    std::thread producer([&] {
+        for (std::size_t i = 0UZ; i < nItems; ++i) {
+            while (true) {
+                pushTime[i] = Clock::now();
+                if (queue->push_back(payload)) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (std::size_t received = 0UZ; received < nItems;) {
+        if (auto item = queue->pop_front()) {
+            latency[received] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - pushTime[received]).count();
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    auto percentile = [&latency](double p) {
+        auto nth = latency.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(latency.size() - 1UZ));
+        std::nth_element(latency.begin(), nth, latency.end());
+        return static_cast<double>(*nth);
+    };
+    return {percentile(0.50), percentile(0.99)};
+}
+
+template<typename T, std::size_t Capacity, QueueLayout layout>
+void runCase(std::size_t nItems) {
+    using Queue           = LockFreeQueue<T, Capacity, layout>;
+    const std::size_t n   = std::is_same_v<T, file::FileData> ? nItems / 10UZ : nItems; // FileData copies its name string per push
+    const double      ops = measureThroughput<Queue>(n);
+    const auto [p50, p99] = measureLatency<Queue>(n / 10UZ);
+    std::println("{:<18} {:>8} {:<18} {:>14.0f} {:>12.0f} {:>12.0f}", payloadName<T>(), Capacity, layout == QueueLayout::Compact ? "Compact" : "CacheLineIsolated", ops, p50, p99);
+}
+
+template<typename T, std::size_t Capacity>
+void runLayouts(std::size_t nItems) {
+    runCase<T, Capacity, QueueLayout::Compact>(nItems);
+    runCase<T, Capacity, QueueLayout::CacheLineIsolated>(nItems);
+}
+
+template<typename T>
+void runCapacities(std::size_t nItems) {
+    runLayouts<T, 64UZ>(nItems);
+    runLayouts<T, 1024UZ>(nItems);
+    runLayouts<T, 1000UZ>(nItems); // non-power-of-two -> modulo wrapping
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t nItems = argc > 1 ? std::stoul(argv[1]) : 10'000'000UZ;
+    std::println("LockFreeQueue SPSC benchmark - {} items, {} hardware threads", nItems, std::thread::hardware_concurrency());
+    std::println("{:<18} {:>8} {:<18} {:>14} {:>12} {:>12}", "payload", "capacity", "layout", "ops/s", "p50 [ns]", "p99 [ns]");
+    runCapacities<int>(nItems);
+    runCapacities<Payload64>(nItems);
+    runCapacities<file::FileData>(nItems);
+    return 0;
+}
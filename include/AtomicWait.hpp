@@ -0,0 +1,177 @@
+#ifndef ATOMICWAIT_HPP
+#define ATOMICWAIT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/threading.h>
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief timed futex-style wait/notify on a 32-bit atomic word
+ *
+ * `std::atomic<T>::wait()` has no timed variant, thus the parking step uses the primitive that backs it directly:
+ * futex(2) on Linux and `Atomics.wait` (emscripten_futex_wait) on WASM. Other platforms fall back to `std::atomic::wait()`
+ * for untimed waits and to short sleeps for timed ones. Waiters and notifiers must both go through these functions.
+ */
+namespace atomic_wait {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) && std::atomic<std::uint32_t>::is_always_lock_free);
+
+inline void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+/// blocks while `word == expected` until notified or `timeout` elapsed (negative: no time limit), spurious wake-ups are possible
+inline void waitFor(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+#if defined(__EMSCRIPTEN__)
+    const double timeoutMs = timeout.count() < 0 ? INFINITY : static_cast<double>(timeout.count()) / 1e6;
+    emscripten_futex_wait(reinterpret_cast<std::uint32_t*>(&word), expected, timeoutMs);
+#elif defined(__linux__)
+    timespec ts{.tv_sec = static_cast<time_t>(timeout.count() / 1'000'000'000), .tv_nsec = static_cast<long>(timeout.count() % 1'000'000'000)};
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout.count() < 0 ? nullptr : &ts, nullptr, 0);
+#else
+    if (timeout.count() < 0) {
+        word.wait(expected, std::memory_order_acquire);
+    } else if (word.load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+    }
+#endif
+}
+
+inline void notifyOne(std::atomic<std::uint32_t>& word) noexcept {
+#if defined(__EMSCRIPTEN__)
+    emscripten_futex_wake(reinterpret_cast<std::uint32_t*>(&word), 1);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+    word.notify_one();
+#endif
+}
+
+inline void notifyAll(std::atomic<std::uint32_t>& word) noexcept {
+#if defined(__EMSCRIPTEN__)
+    emscripten_futex_wake(reinterpret_cast<std::uint32_t*>(&word), INT_MAX);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    word.notify_all();
+#endif
+}
+
+/// converts a relative timeout into a steady_clock deadline, saturating at time_point::max() (== no time limit)
+template<typename Rep, typename Period>
+std::chrono::steady_clock::time_point deadlineAfter(std::chrono::duration<Rep, Period> timeout) noexcept {
+    using Clock = std::chrono::steady_clock;
+    if (timeout >= std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(Clock::time_point::max() - Clock::now())) {
+        return Clock::time_point::max();
+    }
+    return Clock::now() + std::chrono::ceil<Clock::duration>(timeout);
+}
+
+/// blocking is not permitted on the browser's main thread (Atomics.wait throws/busy-waits there)
+inline bool mayBlock() noexcept {
+#if defined(__EMSCRIPTEN__)
+    return !emscripten_is_main_runtime_thread();
+#else
+    return true;
+#endif
+}
+
+} // namespace atomic_wait
+
+/**
+ * @brief wake-up channel between a publishing and a waiting side with a spin -> yield -> park strategy
+ *
+ * The notifying side only pays a fence and a load unless somebody is actually parked. A waiter registers in `_waiters` before
+ * re-checking its condition and parks on `_epoch`, which a notifier bumps before waking, i.e. no wake-up can be lost.
+ *
+ * @code
+ * // publisher:                          // waiter:
+ * tail.store(next, release);             signal.wait_until([&] { return tryPop(); }, deadline);
+ * signal.notify_one();
+ * @endcode
+ */
+struct WaitSignal {
+    static constexpr std::size_t kSpinCount  = 64UZ;
+    static constexpr std::size_t kYieldCount = 16UZ;
+
+    std::atomic<std::uint32_t> _epoch{0U};
+    std::atomic<std::uint32_t> _waiters{0U};
+
+    void notify_one() noexcept { notify<false>(); }
+    void notify_all() noexcept { notify<true>(); }
+
+    /**
+     * @brief spins, yields and finally parks until `tryAcquire()` returns true or `deadline` passed (time_point::max(): no limit)
+     * On the WASM main thread only the non-blocking spin phase is executed.
+     * @return true if `tryAcquire()` succeeded
+     */
+    template<typename Predicate, typename Clock, typename Duration>
+    bool wait_until(Predicate&& tryAcquire, std::chrono::time_point<Clock, Duration> deadline) {
+        for (std::size_t i = 0UZ; i < kSpinCount; ++i) {
+            if (tryAcquire()) {
+                return true;
+            }
+            atomic_wait::cpuRelax();
+        }
+        if (!atomic_wait::mayBlock()) {
+            return tryAcquire();
+        }
+        for (std::size_t i = 0UZ; i < kYieldCount; ++i) {
+            if (tryAcquire()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+
+        const bool unlimited = deadline == std::chrono::time_point<Clock, Duration>::max();
+        while (true) {
+            _waiters.fetch_add(1U, std::memory_order_seq_cst);
+            const std::uint32_t epoch = _epoch.load(std::memory_order_acquire);
+            if (tryAcquire()) {
+                _waiters.fetch_sub(1U, std::memory_order_relaxed);
+                return true;
+            }
+            const auto remaining = unlimited ? std::chrono::nanoseconds(-1) : std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now());
+            if (!unlimited && remaining.count() <= 0) {
+                _waiters.fetch_sub(1U, std::memory_order_relaxed);
+                return false; // timeout
+            }
+            atomic_wait::waitFor(_epoch, epoch, remaining);
+            _waiters.fetch_sub(1U, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    template<bool all>
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // orders the caller's preceding publish before the '_waiters' check
+        if (_waiters.load(std::memory_order_relaxed) == 0U) {
+            return;
+        }
+        _epoch.fetch_add(1U, std::memory_order_release);
+        if constexpr (all) {
+            atomic_wait::notifyAll(_epoch);
+        } else {
+            atomic_wait::notifyOne(_epoch);
+        }
+    }
+};
+
+#endif // ATOMICWAIT_HPP
@@ -0,0 +1,201 @@
+#ifndef BLOBSTORE_HPP
+#define BLOBSTORE_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <unordered_map>
+
+#include <ByteBuffer.hpp>
+
+/// XXH64 (xxHash, 64-bit variant): four independent lanes of 8-byte multiply-rotate rounds, ~memory bandwidth on 64-bit targets
+[[nodiscard]] inline std::uint64_t xxh64(std::span<const std::uint8_t> data, std::uint64_t seed = 0U) noexcept {
+    constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+    auto read64 = [](const std::uint8_t* p) noexcept { // N.B. native byte order: hashes are only compared within the process
+        std::uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    };
+    auto read32 = [](const std::uint8_t* p) noexcept {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    };
+    auto round = [](std::uint64_t acc, std::uint64_t input) noexcept { return std::rotl(acc + input * kPrime2, 31) * kPrime1; };
+    auto merge = [&round](std::uint64_t acc, std::uint64_t lane) noexcept { return (acc ^ round(0U, lane)) * kPrime1 + kPrime4; };
+
+    const std::uint8_t* p   = data.data();
+    const std::uint8_t* end = p + data.size();
+    std::uint64_t       hash;
+    if (data.size() >= 32UZ) {
+        std::uint64_t lane1 = seed + kPrime1 + kPrime2;
+        std::uint64_t lane2 = seed + kPrime2;
+        std::uint64_t lane3 = seed;
+        std::uint64_t lane4 = seed - kPrime1;
+        for (; p + 32 <= end; p += 32) {
+            lane1 = round(lane1, read64(p));
+            lane2 = round(lane2, read64(p + 8));
+            lane3 = round(lane3, read64(p + 16));
+            lane4 = round(lane4, read64(p + 24));
+        }
+        hash = std::rotl(lane1, 1) + std::rotl(lane2, 7) + std::rotl(lane3, 12) + std::rotl(lane4, 18);
+        hash = merge(merge(merge(merge(hash, lane1), lane2), lane3), lane4);
+    } else {
+        hash = seed + kPrime5;
+    }
+    hash += data.size();
+    for (; p + 8 <= end; p += 8) {
+        hash = std::rotl(hash ^ round(0U, read64(p)), 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        hash = std::rotl(hash ^ (read32(p) * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash = std::rotl(hash ^ (*p * kPrime5), 11) * kPrime1;
+    }
+    hash ^= hash >> 33U;
+    hash *= kPrime2;
+    hash ^= hash >> 29U;
+    hash *= kPrime3;
+    hash ^= hash >> 32U;
+    return hash;
+}
+
+/**
+ * @brief content-addressed store of ByteBuffers: identical payloads are kept once and shared
+ *
+ * `intern()` returns the live ByteBuffer with the same content if there is one (the caller's copy is then released with its last
+ * reference), otherwise it registers `data` and returns it unchanged. Content is identified by size and a seeded 64-bit XXH64
+ * hash instead of byte-wise comparison, the seed is random per process (an accidental collision is ~2^-64 per pair).
+ * The store only holds weak references, i.e. it never keeps payloads alive: a blob disappears with its last ByteBuffer and
+ * expired entries are swept lazily. Slices (e.g. the files of an upload buffer) are matched like any other payload, but a new one
+ * is only stored as is if it covers most of its owner (`kMinSliceCoverage`, e.g. a single-file upload): otherwise every later
+ * duplicate would pin the rest of the owner, thus it is copied once into a buffer of its own, which is stored and returned.
+ * Thread-safe.
+ *
+ * ## Example Usage:
+ * @code
+ * BlobStore store;
+ * ByteBuffer a = store.intern(ByteBuffer(std::move(upload1)));
+ * ByteBuffer b = store.intern(ByteBuffer(std::move(upload2))); // same content: 'b' shares 'a's storage, 'upload2' is released
+ * @endcode
+ */
+class BlobStore {
+    struct Key {
+        std::uint64_t hash;
+        std::size_t   size;
+
+        bool operator==(const Key&) const noexcept = default;
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept { return static_cast<std::size_t>(key.hash); }
+    };
+    struct Blob {
+        std::weak_ptr<const void>     owner;
+        std::span<const std::uint8_t> bytes; // valid while 'owner' is alive
+        std::size_t                   ownerSize;
+    };
+
+public:
+    static constexpr double kMinSliceCoverage = 0.75; // fraction of its owner a slice must cover to be stored without a copy
+
+    struct Statistics {
+        std::size_t   interned;     // intern() calls with a non-empty, owning payload
+        std::size_t   deduplicated; // ... that returned an already stored blob
+        std::uint64_t bytesInterned;
+        std::uint64_t bytesSaved; // payload bytes of the deduplicated calls, i.e. not held twice
+        std::size_t   blobs;      // live distinct blobs
+        std::uint64_t bytes;      // ... and their size
+        double        dedupRatio; // bytesInterned / (bytesInterned - bytesSaved), 1: no duplicates seen
+    };
+
+    BlobStore() : _seed(std::random_device{}() | (static_cast<std::uint64_t>(std::random_device{}()) << 32U)) {}
+    BlobStore(const BlobStore&)            = delete;
+    BlobStore& operator=(const BlobStore&) = delete;
+
+    [[nodiscard]] ByteBuffer intern(ByteBuffer data) {
+        if (data.empty() || !data.owner()) {
+            return data; // nothing to share
+        }
+        const Key        key{xxh64(data, _seed), data.size()}; // N.B. hashed outside the lock
+        std::unique_lock lock(_mutex);
+        auto             it = _blobs.find(key);
+        if (it != _blobs.end() && it->second.bytes.data() == data.data()) {
+            return data; // the stored blob itself (e.g. re-delivered from a cache)
+        }
+        ++_statistics.interned;
+        _statistics.bytesInterned += data.size();
+        if (auto stored = lookup(it)) {
+            return *stored;
+        }
+        if (static_cast<double>(data.size()) < kMinSliceCoverage * static_cast<double>(data.ownerSize())) {
+            lock.unlock();
+            data = ByteBuffer::copyOf(data); // N.B. outside the lock, a concurrent intern() of the same content may win meanwhile
+            lock.lock();
+            if (auto stored = lookup(it = _blobs.find(key))) {
+                return *stored;
+            }
+        }
+        if (it != _blobs.end()) {
+            it->second = Blob{data.owner(), data.span(), data.ownerSize()}; // expired: 'data' takes its place
+            return data;
+        }
+        _blobs.emplace(key, Blob{data.owner(), data.span(), data.ownerSize()});
+        if (_blobs.size() >= 2UZ * _liveAtSweep + 64UZ) { // amortised O(1) per insertion
+            std::erase_if(_blobs, [](const auto& entry) { return entry.second.owner.expired(); });
+            _liveAtSweep = _blobs.size();
+        }
+        return data;
+    }
+
+    [[nodiscard]] Statistics statistics() const {
+        std::scoped_lock lock(_mutex);
+        Statistics       statistics = _statistics;
+        for (const auto& [key, blob] : _blobs) {
+            if (!blob.owner.expired()) {
+                ++statistics.blobs;
+                statistics.bytes += key.size;
+            }
+        }
+        const std::uint64_t stored = statistics.bytesInterned - statistics.bytesSaved;
+        statistics.dedupRatio      = stored > 0U ? static_cast<double>(statistics.bytesInterned) / static_cast<double>(stored) : 1.0;
+        return statistics;
+    }
+
+private:
+    using Blobs = std::unordered_map<Key, Blob, KeyHash>;
+
+    // the live blob of 'it' (counted as deduplicated), nullopt if there is none (_mutex held)
+    std::optional<ByteBuffer> lookup(Blobs::iterator it) {
+        if (it == _blobs.end()) {
+            return std::nullopt;
+        }
+        auto owner = it->second.owner.lock();
+        if (!owner) {
+            return std::nullopt;
+        }
+        ++_statistics.deduplicated;
+        _statistics.bytesSaved += it->first.size;
+        return ByteBuffer(std::move(owner), it->second.bytes, it->second.ownerSize);
+    }
+
+    const std::uint64_t _seed;
+    mutable std::mutex  _mutex;
+    Blobs               _blobs;
+    std::size_t         _liveAtSweep = 0UZ; // live blobs after the last sweep of expired ones
+    Statistics          _statistics{};
+};
+
+#endif // BLOBSTORE_HPP
@@ -0,0 +1,81 @@
+#ifndef BYTEBUFFER_HPP
+#define BYTEBUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief immutable, reference-counted view of a contiguous byte block
+ *
+ * Copies and slices share the underlying storage (one atomic increment, no byte copy), the storage is released when the last
+ * ByteBuffer referring to it goes away. The owner is type-erased, i.e. the bytes may live in a `std::vector` (adopted without copy),
+ * in a `malloc`'ed block handed over from JavaScript, or in any other object kept alive by a `std::shared_ptr`.
+ *
+ * ## Example Usage:
+ * @code
+ * ByteBuffer whole(std::move(vector));        // adopts the vector, no copy
+ * ByteBuffer part = whole.slice(16UZ, 128UZ); // shares 'whole's storage
+ * ByteBuffer raw(std::move(owner), std::span(ptr, size)); // 'owner' (any shared_ptr) keeps 'ptr' alive
+ * @endcode
+ */
+class ByteBuffer {
+    std::shared_ptr<const void>   _owner;
+    std::span<const std::uint8_t> _bytes;
+    std::size_t                   _ownerSize = 0UZ; // bytes of the owner's storage, > _bytes.size() for a proper slice (see slice())
+
+public:
+    using value_type     = std::uint8_t;
+    using const_iterator = const std::uint8_t*;
+
+    ByteBuffer() noexcept = default;
+    ByteBuffer(std::shared_ptr<const void> owner, std::span<const std::uint8_t> bytes) noexcept : _owner(std::move(owner)), _bytes(bytes), _ownerSize(bytes.size()) {} // 'bytes': all of 'owner's storage
+    ByteBuffer(std::shared_ptr<const void> owner, std::span<const std::uint8_t> bytes, std::size_t ownerSize) noexcept : _owner(std::move(owner)), _bytes(bytes), _ownerSize(ownerSize) {} // a slice of 'ownerSize' bytes of storage
+    ByteBuffer(std::vector<std::uint8_t>&& bytes) { // implicit by design: FileData{.data = std::move(vector)}
+        auto vector = std::make_shared<const std::vector<std::uint8_t>>(std::move(bytes));
+        _bytes      = std::span(*vector);
+        _ownerSize  = _bytes.size();
+        _owner      = std::move(vector);
+    }
+
+    static ByteBuffer copyOf(std::span<const std::uint8_t> bytes) { return ByteBuffer(std::vector<std::uint8_t>(bytes.begin(), bytes.end())); }
+
+    [[nodiscard]] const std::uint8_t* data() const noexcept { return _bytes.data(); }
+    [[nodiscard]] std::size_t         size() const noexcept { return _bytes.size(); }
+    [[nodiscard]] bool                empty() const noexcept { return _bytes.empty(); }
+    [[nodiscard]] const_iterator      begin() const noexcept { return _bytes.data(); }
+    [[nodiscard]] const_iterator      end() const noexcept { return _bytes.data() + _bytes.size(); }
+    [[nodiscard]] std::uint8_t        operator[](std::size_t index) const noexcept { return _bytes[index]; }
+
+    [[nodiscard]] std::span<const std::uint8_t> span() const noexcept { return _bytes; }
+    operator std::span<const std::uint8_t>() const noexcept { return _bytes; }
+
+    /// number of ByteBuffers sharing the storage (0: empty/non-owning)
+    [[nodiscard]] long useCount() const noexcept { return _owner.use_count(); }
+
+    /// keeps the storage alive, e.g. for weak references that must not (see BlobStore)
+    [[nodiscard]] const std::shared_ptr<const void>& owner() const noexcept { return _owner; }
+
+    /// bytes kept alive by this buffer: its owner's whole storage, i.e. more than size() for (a copy of) a proper slice
+    [[nodiscard]] std::size_t ownerSize() const noexcept { return _ownerSize; }
+    [[nodiscard]] bool        isSlice() const noexcept { return _bytes.size() != _ownerSize; }
+
+    /// sub-range sharing this buffer's storage, throws std::out_of_range if [offset, offset + count) exceeds the buffer
+    [[nodiscard]] ByteBuffer slice(std::size_t offset, std::size_t count) const {
+        if (offset > _bytes.size() || count > _bytes.size() - offset) {
+            throw std::out_of_range("ByteBuffer::slice exceeds buffer");
+        }
+        ByteBuffer part(_owner, _bytes.subspan(offset, count));
+        part._ownerSize = _ownerSize;
+        return part;
+    }
+
+    /// deep copy into a mutable vector (the only operation that copies the bytes)
+    [[nodiscard]] std::vector<std::uint8_t> toVector() const { return {_bytes.begin(), _bytes.end()}; }
+};
+
+#endif // BYTEBUFFER_HPP
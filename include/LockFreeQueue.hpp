@@ -1,92 +1,343 @@
 #ifndef LOCKFREEQUEUE_HPP
 #define LOCKFREEQUEUE_HPP
 
-#include <atomic>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+#include <AtomicWait.hpp>
+
+/**
+ * @brief memory layout of the LockFreeQueue indices
+ *
+ * - Compact: `_head`/`_tail` are packed next to each other and the buffer (smallest footprint, allows the full deque-style interface)
+ * - CacheLineIsolated: producer- and consumer-side indices live on their own cache line, each side keeps a cached copy of the
+ *   peer index and only reloads the shared atomic when the cached copy indicates full/empty. This avoids false sharing and
+ *   coherence traffic when producer and consumer run on different cores. Only the FIFO subset (push_back/pop_front) is available
+ *   since push_front/pop_back would move the peer index backwards behind the cached copy.
+ */
+enum class QueueLayout : std::uint8_t { Compact = 0, CacheLineIsolated };
+
+inline constexpr std::size_t kCacheLineSize = 64UZ; // N.B. std::hardware_destructive_interference_size is not ABI-stable (GCC warns) and missing in older libc++
+
+/**
+ * @brief uninitialised, suitably aligned storage for one queue element, the element's lifetime is managed explicitly by the queue
+ */
+template<typename T>
+union QueueSlot {
+    T value;
+
+    QueueSlot() noexcept {}
+    ~QueueSlot() noexcept {}
+
+    template<typename... Args>
+    T& construct(Args&&... args) {
+        return *std::construct_at(std::addressof(value), std::forward<Args>(args)...);
+    }
+    T take() noexcept(std::is_nothrow_move_constructible_v<T>) { // moves the element out and ends its lifetime
+        T item = std::move(value);
+        std::destroy_at(std::addressof(value));
+        return item;
+    }
+    void destroy() noexcept { std::destroy_at(std::addressof(value)); }
+};
+
+/// push_range() moves the elements of owning rvalue ranges (e.g. a `std::vector` temporary) and copies those of lvalue ranges and of
+/// views/borrowed ranges, which refer to elements owned elsewhere even as prvalue (e.g. `std::span(files)`)
+template<typename Range>
+inline constexpr bool kMovesFromRange = !std::ranges::borrowed_range<Range> && !std::ranges::view<std::remove_cvref_t<Range>>;
+
+template<typename Range>
+using RangeSource = std::conditional_t<kMovesFromRange<Range>, std::ranges::range_rvalue_reference_t<Range>, std::ranges::range_reference_t<Range>>;
+
+template<typename Range, typename Iterator>
+constexpr RangeSource<Range> rangeElement(const Iterator& it) {
+    if constexpr (kMovesFromRange<Range>) {
+        return std::ranges::iter_move(it);
+    } else {
+        return *it;
+    }
+}
 
 /**
  * @brief Lock-free single-producer single-consumer (SPSC) queue with deque-style interface.
  *
+ * The producer thread owns `_tail` (push_back, pop_back), the consumer thread owns `_head` (pop_front, push_front).
+ * One slot is kept free to distinguish 'full' from 'empty', i.e. the queue holds at most `Capacity - 1` elements.
+ * Slots are uninitialised storage: elements are constructed in place on push/emplace and destroyed on pop, i.e. `T` needs
+ * neither be default-constructible nor copyable, and rvalues are moved (not copied) through the queue.
+ * If `Capacity` is a power of two, index wrapping uses a bit-mask instead of the modulo operation.
+ *
  * ## Example Usage:
  * @code
  * LockFreeQueue<int, 8> queue;
  * queue.push_back(42);
  * queue.push_front(1);
+ * queue.emplace_back(43); // constructs in place
  *
  * if (auto val = queue.pop_front()) {
  *     std::cout << *val << std::endl;
  * }
+ *
+ * LockFreeQueue<FileData, 64, QueueLayout::CacheLineIsolated> fifo; // FIFO-only, producer/consumer on different cores
+ * std::size_t nPushed = fifo.push_range(std::move(files)); // bulk: moves up to 'capacity()' elements, single publish
+ * std::array<FileData, 16> batch;
+ * std::size_t nPopped = fifo.pop_into(batch); // bulk: moves up to 16 elements, single publish
+ *
+ * // blocking variants (spin -> yield -> park, woken immediately by the peer; non-blocking on the WASM main thread):
+ * if (auto file = fifo.pop_front_wait(std::chrono::milliseconds(100))) { ... }
+ * bool pushed = fifo.push_back_wait(file, std::chrono::seconds(1));
  * @endcode
  */
-template<typename T, std::size_t Capacity>
+template<typename T, std::size_t Capacity, QueueLayout layout = QueueLayout::Compact>
 struct LockFreeQueue {
-    std::array<T, Capacity>  _buffer;
-    std::atomic<std::size_t> _head{0}; // points to front element
-    std::atomic<std::size_t> _tail{0}; // points to one past the last element
+    static_assert(Capacity >= 2UZ, "need at least one usable slot (one slot is reserved to distinguish full from empty)");
+    static constexpr bool        kIsolated   = layout == QueueLayout::CacheLineIsolated;
+    static constexpr bool        kPowerOfTwo = std::has_single_bit(Capacity);
+    static constexpr std::size_t kAlignment  = kIsolated ? kCacheLineSize : alignof(std::atomic<std::size_t>);
+
+    alignas(kAlignment) std::array<QueueSlot<T>, Capacity> _buffer;
+    alignas(kAlignment) std::atomic<std::size_t> _head{0}; // points to front element
+    std::size_t _cachedTail{0};                            // consumer-side copy of '_tail' (CacheLineIsolated only)
+    WaitSignal  _popSignal;                                // producers waiting for free space park here
+    alignas(kAlignment) std::atomic<std::size_t> _tail{0}; // points to one past the last element
+    std::size_t _cachedHead{0};                            // producer-side copy of '_head' (CacheLineIsolated only)
+    WaitSignal  _pushSignal;                               // consumers waiting for data park here
+
+    LockFreeQueue() noexcept = default;
+    LockFreeQueue(const LockFreeQueue&)            = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+    ~LockFreeQueue() noexcept { // N.B. requires that neither producer nor consumer access the queue anymore
+        for (auto i = _head.load(std::memory_order_acquire), tail = _tail.load(std::memory_order_acquire); i != tail; i = next(i)) {
+            _buffer[i].destroy();
+        }
+    }
+
+    static constexpr std::size_t wrap(std::size_t i) noexcept {
+        if constexpr (kPowerOfTwo) {
+            return i & (Capacity - 1UZ);
+        } else {
+            return i % Capacity;
+        }
+    }
+    static constexpr std::size_t next(std::size_t i) noexcept { return wrap(i + 1UZ); }
+    static constexpr std::size_t prev(std::size_t i) noexcept { return wrap(i + Capacity - 1UZ); }
+    static constexpr std::size_t capacity() noexcept { return Capacity - 1UZ; }
+
+    static constexpr std::size_t distance(std::size_t from, std::size_t to) noexcept { return wrap(to + Capacity - from); }
 
-    constexpr std::size_t next(std::size_t i) const noexcept { return (i + 1) % Capacity; }
-    constexpr std::size_t prev(std::size_t i) const noexcept { return (i + Capacity - 1) % Capacity; }
-    bool                  empty() const noexcept { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
-    bool                  full() const noexcept { return next(_tail.load(std::memory_order_acquire)) == _head.load(std::memory_order_acquire); }
+    bool        empty() const noexcept { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+    bool        full() const noexcept { return next(_tail.load(std::memory_order_acquire)) == _head.load(std::memory_order_acquire); }
+    std::size_t size() const noexcept { return distance(_head.load(std::memory_order_acquire), _tail.load(std::memory_order_acquire)); } // approximate if accessed concurrently
 
-    bool push_back(const T& item) {
+    /// constructs the element in place at the back, the arguments are not consumed if the queue is full
+    template<typename... Args>
+    requires std::is_constructible_v<T, Args...>
+    bool emplace_back(Args&&... args) {
         auto tail      = _tail.load(std::memory_order_relaxed);
         auto next_tail = next(tail);
-        if (next_tail == _head.load(std::memory_order_acquire))
+        if (next_tail == producerHead(next_tail)) {
             return false; // full
-        _buffer[tail] = item;
+        }
+        _buffer[tail].construct(std::forward<Args>(args)...);
         _tail.store(next_tail, std::memory_order_release);
+        _pushSignal.notify_one();
         return true;
     }
 
-    bool push_front(const T& item) {
+    /// constructs the element in place at the front, the arguments are not consumed if the queue is full
+    template<typename... Args>
+    requires(!kIsolated && std::is_constructible_v<T, Args...>)
+    bool emplace_front(Args&&... args) {
         auto head     = _head.load(std::memory_order_relaxed);
         auto new_head = prev(head);
         if (_tail.load(std::memory_order_acquire) == new_head) {
             return false; // full
         }
-        _buffer[new_head] = item;
+        _buffer[new_head].construct(std::forward<Args>(args)...);
         _head.store(new_head, std::memory_order_release);
         return true;
     }
 
+    bool push_back(const T& item) { return emplace_back(item); }
+    bool push_back(T&& item) { return emplace_back(std::move(item)); }
+
+    bool push_front(const T& item)
+    requires(!kIsolated)
+    {
+        return emplace_front(item);
+    }
+
+    bool push_front(T&& item)
+    requires(!kIsolated)
+    {
+        return emplace_front(std::move(item));
+    }
+
     std::optional<T> pop_front() {
         auto head = _head.load(std::memory_order_relaxed);
-        if (head == _tail.load(std::memory_order_acquire)) {
+        if (head == consumerTail(head)) {
             return std::nullopt; // empty
         }
-        T item = std::move(_buffer[head]);
+        T item = _buffer[head].take();
         _head.store(next(head), std::memory_order_release);
+        _popSignal.notify_one();
         return item;
     }
 
-    std::optional<T> pop_back() {
+    std::optional<T> pop_back()
+    requires(!kIsolated)
+    {
         auto tail = _tail.load(std::memory_order_relaxed);
         if (_head.load(std::memory_order_acquire) == tail) {
             return std::nullopt; // empty
         }
         auto new_tail = prev(tail);
-        T    item     = std::move(_buffer[new_tail]);
+        T    item     = _buffer[new_tail].take();
         _tail.store(new_tail, std::memory_order_release);
         return item;
     }
 
-    std::optional<T> front() const {
+    /**
+     * @brief producer-side bulk push: claims up to `std::ranges::size(items)` free slots, moves or copies (see kMovesFromRange) the
+     * leading elements into them and publishes all of them with a single release store. If constructing an element throws, the
+     * elements constructed so far are destroyed and nothing is published.
+     * @return number of elements pushed (less than the range size if the queue ran full)
+     */
+    template<std::ranges::sized_range Range>
+    requires std::is_convertible_v<std::ranges::range_reference_t<Range>, const T&>
+    std::size_t push_range(Range&& items) {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        const auto n    = std::min(static_cast<std::size_t>(std::ranges::size(items)), producerFree(tail, static_cast<std::size_t>(std::ranges::size(items))));
+        if (n == 0UZ) {
+            return 0UZ;
+        }
+        auto        it = std::ranges::begin(items);
+        std::size_t i  = 0UZ;
+        try {
+            for (; i < n; ++i, ++it) {
+                _buffer[wrap(tail + i)].construct(rangeElement<Range>(it));
+            }
+        } catch (...) { // e.g. a copy that failed to allocate: the unpublished slots must not keep live elements
+            while (i > 0UZ) {
+                _buffer[wrap(tail + --i)].destroy();
+            }
+            throw;
+        }
+        _tail.store(wrap(tail + n), std::memory_order_release);
+        _pushSignal.notify_one();
+        return n;
+    }
+
+    /**
+     * @brief consumer-side bulk pop: moves up to `out.size()` front elements into `out` and releases all of their slots with a single release store.
+     * @return number of elements written to the front of `out`
+     */
+    std::size_t pop_into(std::span<T> out) {
+        const auto head = _head.load(std::memory_order_relaxed);
+        const auto n    = std::min(out.size(), consumerAvailable(head, out.size()));
+        if (n == 0UZ) {
+            return 0UZ;
+        }
+        for (std::size_t i = 0UZ; i < n; ++i) {
+            out[i] = _buffer[wrap(head + i)].take();
+        }
+        _head.store(wrap(head + n), std::memory_order_release);
+        _popSignal.notify_one();
+        return n;
+    }
+
+    /// consumer-side blocking pop_front(): waits until an element arrives or `timeout` elapsed (default: no time limit)
+    template<typename Rep = std::int64_t, typename Period = std::nano>
+    std::optional<T> pop_front_wait(std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>::max()) {
+        std::optional<T> item;
+        _pushSignal.wait_until([&] { return (item = pop_front()).has_value(); }, atomic_wait::deadlineAfter(timeout));
+        return item;
+    }
+
+    /// producer-side blocking push_back(): waits until a slot is free or `timeout` elapsed (default: no time limit), an rvalue `item` is only moved from on success
+    template<typename U, typename Rep = std::int64_t, typename Period = std::nano>
+    requires std::is_constructible_v<T, U&&>
+    bool push_back_wait(U&& item, std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>::max()) {
+        return _popSignal.wait_until([&] { return emplace_back(std::forward<U>(item)); }, atomic_wait::deadlineAfter(timeout));
+    }
+
+    std::optional<T> front() const
+    requires std::is_copy_constructible_v<T>
+    {
         auto head = _head.load(std::memory_order_acquire);
         if (head == _tail.load(std::memory_order_acquire)) {
             return std::nullopt;
         }
-        return _buffer[head];
+        return _buffer[head].value;
     }
 
-    std::optional<T> back() const {
+    std::optional<T> back() const
+    requires std::is_copy_constructible_v<T>
+    {
         auto tail = _tail.load(std::memory_order_acquire);
         if (_head.load(std::memory_order_acquire) == tail) {
             return std::nullopt;
         }
-        return _buffer[prev(tail)];
+        return _buffer[prev(tail)].value;
+    }
+
+private:
+    // producer side: returns the consumer index, reloading the shared atomic only if the cached copy signals 'full'
+    std::size_t producerHead(std::size_t next_tail) noexcept {
+        if constexpr (kIsolated) {
+            if (next_tail == _cachedHead) {
+                _cachedHead = _head.load(std::memory_order_acquire);
+            }
+            return _cachedHead;
+        } else {
+            return _head.load(std::memory_order_acquire);
+        }
+    }
+
+    // producer side: number of free slots, reloading the shared atomic only if the cached copy has fewer than 'wanted'
+    std::size_t producerFree(std::size_t tail, std::size_t wanted) noexcept {
+        if constexpr (kIsolated) {
+            if (capacity() - distance(_cachedHead, tail) < wanted) {
+                _cachedHead = _head.load(std::memory_order_acquire);
+            }
+            return capacity() - distance(_cachedHead, tail);
+        } else {
+            return capacity() - distance(_head.load(std::memory_order_acquire), tail);
+        }
+    }
+
+    // consumer side: number of readable elements, reloading the shared atomic only if the cached copy has fewer than 'wanted'
+    std::size_t consumerAvailable(std::size_t head, std::size_t wanted) noexcept {
+        if constexpr (kIsolated) {
+            if (distance(head, _cachedTail) < wanted) {
+                _cachedTail = _tail.load(std::memory_order_acquire);
+            }
+            return distance(head, _cachedTail);
+        } else {
+            return distance(head, _tail.load(std::memory_order_acquire));
+        }
+    }
+
+    // consumer side: returns the producer index, reloading the shared atomic only if the cached copy signals 'empty'
+    std::size_t consumerTail(std::size_t head) noexcept {
+        if constexpr (kIsolated) {
+            if (head == _cachedTail) {
+                _cachedTail = _tail.load(std::memory_order_acquire);
+            }
+            return _cachedTail;
+        } else {
+            return _tail.load(std::memory_order_acquire);
+        }
     }
 };
 
-#endif //LOCKFREEQUEUE_HPP
\ No newline at end of file
+#endif //LOCKFREEQUEUE_HPP
@@ -0,0 +1,149 @@
+#ifndef LRUCACHE_HPP
+#define LRUCACHE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief least-recently-used cache bounded by a cost budget (e.g. bytes) instead of an entry count
+ *
+ * `insert()` evicts least-recently used entries until the new one fits, entries costing more than the whole budget are rejected.
+ * `find()` refreshes an entry's recency. Not thread-safe: the owner serialises access (it typically needs the lock anyway to
+ * combine lookups with other state). The statistics are meant for tuning the budget, e.g. against WASM heap limits: frequent
+ * evictions or rejections at a low hit rate indicate a budget that is too small for the working set.
+ *
+ * ## Example Usage:
+ * @code
+ * LruCache<std::string, ByteBuffer> cache(64UZ << 20); // 64 MiB
+ * cache.insert("logo.png", buffer, buffer.size());
+ * if (const ByteBuffer* hit = cache.find("logo.png")) { ... }
+ * @endcode
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+    struct Node {
+        Key         key;
+        Value       value;
+        std::size_t cost;
+    };
+    using Iterator = typename std::list<Node>::iterator;
+
+public:
+    struct Statistics {
+        std::size_t hits;
+        std::size_t misses;
+        std::size_t insertions;
+        std::size_t evictions; // entries dropped to make room for newer ones
+        std::size_t rejected;  // entries costing more than the whole budget
+        std::size_t entries;
+        std::size_t cost;
+        std::size_t peakCost;
+        std::size_t budget;
+    };
+
+    explicit LruCache(std::size_t budget) : _budget(budget) {}
+
+    /// returns the cached value (valid until the next modification) and marks it most recently used, nullptr if absent
+    [[nodiscard]] const Value* find(const Key& key) {
+        auto it = _index.find(key);
+        if (it == _index.end()) {
+            ++_statistics.misses;
+            return nullptr;
+        }
+        ++_statistics.hits;
+        _order.splice(_order.begin(), _order, it->second);
+        return &it->second->value;
+    }
+
+    [[nodiscard]] bool contains(const Key& key) const { return _index.contains(key); }
+
+    /// inserts or replaces `key`, returns false (and leaves the cache unchanged) if `cost` exceeds the budget
+    bool insert(Key key, Value value, std::size_t cost) {
+        if (cost > _budget) {
+            ++_statistics.rejected;
+            return false;
+        }
+        erase(key);
+        _order.push_front(Node{key, std::move(value), cost});
+        _index.emplace(std::move(key), _order.begin());
+        _cost += cost;
+        _statistics.peakCost = std::max(_statistics.peakCost, _cost);
+        ++_statistics.insertions;
+        shrinkTo(_budget);
+        return true;
+    }
+
+    bool erase(const Key& key) {
+        auto it = _index.find(key);
+        if (it == _index.end()) {
+            return false;
+        }
+        _cost -= it->second->cost;
+        _order.erase(it->second);
+        _index.erase(it);
+        return true;
+    }
+
+    /// erases all entries whose key satisfies `predicate`, returns their number
+    template<typename Predicate>
+    std::size_t eraseIf(Predicate predicate) {
+        std::size_t n = 0UZ;
+        for (auto it = _order.begin(); it != _order.end();) {
+            if (!predicate(std::as_const(it->key))) {
+                ++it;
+                continue;
+            }
+            _cost -= it->cost;
+            _index.erase(it->key);
+            it = _order.erase(it);
+            ++n;
+        }
+        return n;
+    }
+
+    void clear() {
+        _order.clear();
+        _index.clear();
+        _cost = 0UZ;
+    }
+
+    /// changes the budget, evicting least-recently used entries if the cached cost exceeds it
+    void setBudget(std::size_t budget) {
+        _budget = budget;
+        shrinkTo(budget);
+    }
+
+    [[nodiscard]] std::size_t budget() const noexcept { return _budget; }
+    [[nodiscard]] std::size_t cost() const noexcept { return _cost; }
+    [[nodiscard]] std::size_t size() const noexcept { return _index.size(); }
+
+    [[nodiscard]] Statistics statistics() const noexcept {
+        Statistics statistics = _statistics;
+        statistics.entries    = _index.size();
+        statistics.cost       = _cost;
+        statistics.budget     = _budget;
+        return statistics;
+    }
+
+private:
+    std::list<Node>                         _order; // front: most recently used
+    std::unordered_map<Key, Iterator, Hash> _index;
+    std::size_t                             _budget;
+    std::size_t                             _cost = 0UZ;
+    Statistics                              _statistics{};
+
+    void shrinkTo(std::size_t budget) {
+        while (_cost > budget && !_order.empty()) {
+            _cost -= _order.back().cost;
+            _index.erase(_order.back().key);
+            _order.pop_back();
+            ++_statistics.evictions;
+        }
+    }
+};
+
+#endif // LRUCACHE_HPP
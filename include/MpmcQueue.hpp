@@ -0,0 +1,233 @@
+#ifndef MPMCQUEUE_HPP
+#define MPMCQUEUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+#include <AtomicWait.hpp>
+#include <LockFreeQueue.hpp>
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer (MPMC) queue (sequence-numbered ring, D. Vyukov's design).
+ *
+ * Every slot carries a sequence number that encodes whether it is free for the producer of a given lap (`seq == pos`) or holds
+ * data for the consumer of that lap (`seq == pos + 1`). Producers/consumers claim positions with a CAS on `_enqueuePos`/`_dequeuePos`
+ * and publish the slot by advancing its sequence number, i.e. there are no lost or torn entries even with many concurrent producers.
+ * Offers the FIFO subset of the LockFreeQueue interface (push_back/emplace_back/pop_front, push_range/pop_into, ...); unlike the
+ * SPSC queue all `Capacity` slots are usable. Slots are uninitialised storage (see QueueSlot), elements are constructed in place.
+ *
+ * ## Example Usage:
+ * @code
+ * MpmcQueue<FileData, 64> queue;
+ * // any number of threads:
+ * queue.push_back(FileData{...});
+ * // any number of threads:
+ * if (auto file = queue.pop_front()) { ... }
+ * if (auto file = queue.pop_front_wait(std::chrono::milliseconds(100))) { ... } // blocking variant
+ * @endcode
+ */
+template<typename T, std::size_t Capacity>
+struct MpmcQueue {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "elements are moved into claimed slots, which must not fail");
+
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        QueueSlot<T>             storage;
+    };
+
+    alignas(kCacheLineSize) std::array<Slot, Capacity> _buffer;
+    alignas(kCacheLineSize) std::atomic<std::size_t> _enqueuePos{0}; // next position to be claimed by a producer
+    WaitSignal _pushSignal;                                          // consumers waiting for data park here
+    alignas(kCacheLineSize) std::atomic<std::size_t> _dequeuePos{0}; // next position to be claimed by a consumer
+    WaitSignal _popSignal;                                           // producers waiting for free space park here
+
+    MpmcQueue() noexcept {
+        for (std::size_t i = 0UZ; i < Capacity; ++i) {
+            _buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    MpmcQueue(const MpmcQueue&)            = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+    ~MpmcQueue() noexcept { // N.B. requires that no producer or consumer accesses the queue anymore
+        for (auto pos = _dequeuePos.load(std::memory_order_acquire), end = _enqueuePos.load(std::memory_order_acquire); pos != end; ++pos) {
+            if (_buffer[wrap(pos)].sequence.load(std::memory_order_acquire) == pos + 1UZ) {
+                _buffer[wrap(pos)].storage.destroy();
+            }
+        }
+    }
+
+    static constexpr std::size_t wrap(std::size_t pos) noexcept { return pos & (Capacity - 1UZ); }
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+    bool        empty() const noexcept { return size() == 0UZ; }
+    bool        full() const noexcept { return size() >= Capacity; }
+    std::size_t size() const noexcept { // approximate if accessed concurrently
+        const auto dequeuePos = _dequeuePos.load(std::memory_order_acquire);
+        const auto enqueuePos = _enqueuePos.load(std::memory_order_acquire);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0UZ;
+    }
+
+    /**
+     * @brief constructs the element in place at the back, the arguments are not consumed if the queue is full
+     *
+     * N.B. a claimed slot must be published: if T's constructor may throw, the element is built in a temporary first and moved
+     * into the slot (the arguments are then consumed even if the queue is full).
+     */
+    template<typename... Args>
+    requires std::is_constructible_v<T, Args...>
+    bool emplace_back(Args&&... args) {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            return emplace_back(T(std::forward<Args>(args)...));
+        } else {
+            std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            if (claimProducer(pos, 1UZ) == 0UZ) {
+                return false; // full
+            }
+            Slot& slot = _buffer[wrap(pos)];
+            slot.storage.construct(std::forward<Args>(args)...);
+            slot.sequence.store(pos + 1UZ, std::memory_order_release);
+            _pushSignal.notify_one();
+            return true;
+        }
+    }
+
+    bool push_back(const T& item) { return emplace_back(item); }
+    bool push_back(T&& item) { return emplace_back(std::move(item)); }
+
+    std::optional<T> pop_front() {
+        std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        if (claimConsumer(pos, 1UZ) == 0UZ) {
+            return std::nullopt; // empty
+        }
+        Slot& slot = _buffer[wrap(pos)];
+        T     item = slot.storage.take();
+        slot.sequence.store(pos + Capacity, std::memory_order_release);
+        _popSignal.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief bulk push: claims up to `std::ranges::size(items)` consecutive free slots with a single CAS and moves or copies (see
+     * kMovesFromRange) the leading elements into them.
+     * @return number of elements pushed (less than the range size if the queue ran full)
+     */
+    template<std::ranges::sized_range Range>
+    requires std::is_convertible_v<std::ranges::range_reference_t<Range>, const T&>
+    std::size_t push_range(Range&& items) {
+        using Source = RangeSource<Range>;
+        if constexpr (!std::is_nothrow_constructible_v<T, Source>) { // e.g. copies that allocate: one at a time, see emplace_back()
+            const auto  n      = static_cast<std::size_t>(std::ranges::size(items));
+            std::size_t pushed = 0UZ;
+            for (auto it = std::ranges::begin(items); pushed < n && emplace_back(rangeElement<Range>(it)); ++it) {
+                ++pushed;
+            }
+            return pushed;
+        } else {
+            std::size_t       pos = _enqueuePos.load(std::memory_order_relaxed);
+            const std::size_t n   = claimProducer(pos, static_cast<std::size_t>(std::ranges::size(items)));
+            auto              it  = std::ranges::begin(items);
+            for (std::size_t i = 0UZ; i < n; ++i, ++it) {
+                Slot& slot = _buffer[wrap(pos + i)];
+                slot.storage.construct(rangeElement<Range>(it));
+                slot.sequence.store(pos + i + 1UZ, std::memory_order_release);
+            }
+            if (n > 0UZ) {
+                _pushSignal.notify_all(); // possibly several consumers can make progress
+            }
+            return n;
+        }
+    }
+
+    /**
+     * @brief bulk pop: claims up to `out.size()` consecutive ready slots with a single CAS and moves them into `out`.
+     * @return number of elements written to the front of `out`
+     */
+    std::size_t pop_into(std::span<T> out) {
+        std::size_t       pos = _dequeuePos.load(std::memory_order_relaxed);
+        const std::size_t n   = claimConsumer(pos, out.size());
+        for (std::size_t i = 0UZ; i < n; ++i) {
+            Slot& slot = _buffer[wrap(pos + i)];
+            out[i]     = slot.storage.take();
+            slot.sequence.store(pos + i + Capacity, std::memory_order_release);
+        }
+        if (n > 0UZ) {
+            _popSignal.notify_all(); // possibly several producers can make progress
+        }
+        return n;
+    }
+
+    /// blocking pop_front(): waits until an element arrives or `timeout` elapsed (default: no time limit)
+    template<typename Rep = std::int64_t, typename Period = std::nano>
+    std::optional<T> pop_front_wait(std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>::max()) {
+        std::optional<T> item;
+        _pushSignal.wait_until([&] { return (item = pop_front()).has_value(); }, atomic_wait::deadlineAfter(timeout));
+        return item;
+    }
+
+    /// blocking push_back(): waits until a slot is free or `timeout` elapsed (default: no time limit), an rvalue `item` is only moved from on success
+    template<typename U, typename Rep = std::int64_t, typename Period = std::nano>
+    requires std::is_constructible_v<T, U&&>
+    bool push_back_wait(U&& item, std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>::max()) {
+        return _popSignal.wait_until([&] { return emplace_back(std::forward<U>(item)); }, atomic_wait::deadlineAfter(timeout));
+    }
+
+private:
+    // claims up to 'wanted' consecutive free slots starting at 'pos' (updated to the claimed start position), returns the number claimed
+    std::size_t claimProducer(std::size_t& pos, std::size_t wanted) noexcept {
+        while (wanted > 0UZ) {
+            std::size_t n = 0UZ;
+            for (; n < wanted && n < Capacity; ++n) {
+                if (_buffer[wrap(pos + n)].sequence.load(std::memory_order_acquire) != pos + n) {
+                    break;
+                }
+            }
+            if (n == 0UZ) {
+                const auto seq = _buffer[wrap(pos)].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - pos) < 0) {
+                    return 0UZ; // slot still occupied from the previous lap -> full
+                }
+                pos = _enqueuePos.load(std::memory_order_relaxed); // another producer was faster
+                continue;
+            }
+            if (_enqueuePos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                return n;
+            }
+        }
+        return 0UZ;
+    }
+
+    // claims up to 'wanted' consecutive ready slots starting at 'pos' (updated to the claimed start position), returns the number claimed
+    std::size_t claimConsumer(std::size_t& pos, std::size_t wanted) noexcept {
+        while (wanted > 0UZ) {
+            std::size_t n = 0UZ;
+            for (; n < wanted && n < Capacity; ++n) {
+                if (_buffer[wrap(pos + n)].sequence.load(std::memory_order_acquire) != pos + n + 1UZ) {
+                    break;
+                }
+            }
+            if (n == 0UZ) {
+                const auto seq = _buffer[wrap(pos)].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - (pos + 1UZ)) < 0) {
+                    return 0UZ; // slot not yet published -> empty
+                }
+                pos = _dequeuePos.load(std::memory_order_relaxed); // another consumer was faster
+                continue;
+            }
+            if (_dequeuePos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                return n;
+            }
+        }
+        return 0UZ;
+    }
+};
+
+#endif // MPMCQUEUE_HPP
@@ -0,0 +1,25 @@
+#ifndef QUEUEPOLICY_HPP
+#define QUEUEPOLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <LockFreeQueue.hpp>
+#include <MpmcQueue.hpp>
+#include <SegmentedQueue.hpp>
+
+/**
+ * @brief producer/consumer policy for the lock-free queues, selects the cheapest queue that is safe for the given access pattern
+ *
+ * - SingleProducer: exactly one producer and one consumer thread -> LockFreeQueue (CacheLineIsolated layout, holds `Capacity - 1` elements)
+ * - MultiProducer: any number of producer and consumer threads -> MpmcQueue (holds `Capacity` elements)
+ * - Unbounded: any number of producers, one consumer thread -> SegmentedQueue (grows in segments of `Capacity` elements, never drops)
+ */
+enum class QueuePolicy : std::uint8_t { SingleProducer = 0, MultiProducer, Unbounded };
+
+template<typename T, std::size_t Capacity, QueuePolicy policy>
+using PolicyQueue = std::conditional_t<policy == QueuePolicy::SingleProducer, LockFreeQueue<T, Capacity, QueueLayout::CacheLineIsolated>, //
+    std::conditional_t<policy == QueuePolicy::MultiProducer, MpmcQueue<T, Capacity>, SegmentedQueue<T, Capacity>>>;
+
+#endif // QUEUEPOLICY_HPP
@@ -0,0 +1,163 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include <SegmentedQueue.hpp>
+
+/// where a continuation or resumed coroutine runs
+enum class Executor : std::uint8_t { MainThread = 0, Worker };
+
+/**
+ * @brief minimal task scheduler with a main-thread queue and a small worker pool
+ *
+ * - MainThread: tasks are queued (lock-free, from any thread) and executed by `runMainThreadTasks()`, which the render loop calls
+ *   once per frame, i.e. continuations may touch ImGui/GL state and never block the browser's main thread.
+ * - Worker: tasks are executed by `nWorkers` threads that are started on first use (keeps the WASM pthread pool free otherwise).
+ *
+ * @code
+ * Task pipeline() {
+ *     auto files = co_await file::FileIo::instance().loadFile("trace.bin").on(Executor::Worker); // resumes on a worker
+ *     auto image = decode(files);
+ *     co_await Scheduler::instance().schedule(Executor::MainThread); // hop back to the render thread
+ *     uploadToGpu(image);
+ * }
+ * // render loop:
+ * Scheduler::instance().runMainThreadTasks();
+ * @endcode
+ */
+class Scheduler {
+    using Function = std::function<void()>;
+
+    SegmentedQueue<Function, 64UZ> _mainThreadTasks; // any thread -> main thread (single consumer)
+    std::mutex                     _workerMutex;
+    std::condition_variable        _workAvailable;
+    std::deque<Function>           _workerTasks;
+    std::vector<std::thread>       _workers;
+    std::size_t                    _nWorkers;
+    bool                           _stopping = false;
+
+    static void run(Function& task) noexcept {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::println(stderr, "[Scheduler] task threw: {}", e.what());
+        } catch (...) {
+            std::println(stderr, "[Scheduler] task threw an unknown exception");
+        }
+    }
+
+    void runWorker() {
+        std::unique_lock lock(_workerMutex);
+        while (true) {
+            _workAvailable.wait(lock, [this] { return _stopping || !_workerTasks.empty(); });
+            if (_workerTasks.empty()) {
+                return; // stopping and drained
+            }
+            Function task = std::move(_workerTasks.front());
+            _workerTasks.pop_front();
+            lock.unlock();
+            run(task);
+            lock.lock();
+        }
+    }
+
+public:
+    explicit Scheduler(std::size_t nWorkers = 2UZ) : _nWorkers(std::max(nWorkers, 1UZ)) {}
+    Scheduler(const Scheduler&)            = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+    ~Scheduler() noexcept { // N.B. remaining main-thread tasks are dropped, remaining worker tasks are executed
+        {
+            std::scoped_lock lock(_workerMutex);
+            _stopping = true;
+        }
+        _workAvailable.notify_all();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    static Scheduler& instance() noexcept {
+        static Scheduler singleton;
+        return singleton;
+    }
+
+    void post(Executor executor, Function task) {
+        if (executor == Executor::MainThread) {
+            _mainThreadTasks.push_back(std::move(task));
+            return;
+        }
+        {
+            std::scoped_lock lock(_workerMutex);
+            if (_workers.empty()) {
+                for (std::size_t i = 0UZ; i < _nWorkers; ++i) {
+                    _workers.emplace_back(&Scheduler::runWorker, this);
+                }
+            }
+            _workerTasks.push_back(std::move(task));
+        }
+        _workAvailable.notify_one();
+    }
+
+    /// executes queued main-thread tasks (call from the main/render thread only), returns the number of tasks run
+    std::size_t runMainThreadTasks(std::size_t maxTasks = std::numeric_limits<std::size_t>::max()) {
+        std::size_t n = 0UZ;
+        for (; n < maxTasks; ++n) {
+            auto task = _mainThreadTasks.pop_front();
+            if (!task) {
+                break;
+            }
+            run(*task);
+        }
+        return n;
+    }
+
+    /// `co_await scheduler.schedule(executor)` continues the calling coroutine on `executor`
+    [[nodiscard]] auto schedule(Executor executor) noexcept {
+        struct Awaiter {
+            Scheduler& scheduler;
+            Executor   executor;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.post(executor, [handle] { handle.resume(); }); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this, executor};
+    }
+};
+
+/**
+ * @brief fire-and-forget coroutine: starts eagerly, runs until its first suspension and then continues wherever it is resumed,
+ * its frame is destroyed on completion. Exceptions escaping the coroutine body are logged.
+ */
+struct Task {
+    struct promise_type {
+        Task               get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void               return_void() const noexcept {}
+        void               unhandled_exception() const noexcept {
+            try {
+                std::rethrow_exception(std::current_exception());
+            } catch (const std::exception& e) {
+                std::println(stderr, "[Task] unhandled exception: {}", e.what());
+            } catch (...) {
+                std::println(stderr, "[Task] unhandled unknown exception");
+            }
+        }
+    };
+};
+
+#endif // SCHEDULER_HPP
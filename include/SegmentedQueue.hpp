@@ -0,0 +1,280 @@
+#ifndef SEGMENTEDQUEUE_HPP
+#define SEGMENTEDQUEUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <AtomicWait.hpp>
+#include <LockFreeQueue.hpp>
+
+/**
+ * @brief Unbounded lock-free multi-producer single-consumer (MPSC) queue built from a linked list of fixed-size segments.
+ *
+ * Fast path (lock-free): producers claim a slot in the tail segment with a single `fetch_add` and publish it through a per-slot
+ * ready flag, the single consumer walks the head segment with a plain index. Slow path: when the tail segment is exhausted, one
+ * producer links a new segment under `_growMutex`, preferring a recycled segment from the free list over a heap allocation.
+ * Fully consumed segments are pushed onto the free list by the consumer. A per-segment `users` count guards against producers that
+ * still hold a pointer to a segment the consumer wants to recycle.
+ *
+ * `highWaterMark()` reports the peak number of simultaneously linked segments (times `SegmentSize`), use it to size `SegmentSize`
+ * such that typical workloads fit in one or two segments.
+ *
+ * ## Example Usage:
+ * @code
+ * SegmentedQueue<FileData, 64> queue;
+ * queue.push_back(FileData{...});            // any thread, never fails (allocates on demand)
+ * if (auto file = queue.pop_front()) { ... } // one consumer thread
+ * auto stats = queue.statistics();
+ * @endcode
+ */
+template<typename T, std::size_t SegmentSize>
+class SegmentedQueue {
+    static_assert(SegmentSize >= 1UZ);
+    static_assert(std::is_nothrow_move_constructible_v<T>, "elements are moved into claimed slots, which must not fail");
+
+    struct Slot {
+        std::atomic<bool> ready{false};
+        QueueSlot<T>      storage;
+    };
+
+    struct Segment {
+        alignas(kCacheLineSize) std::atomic<std::size_t> claimed{0UZ}; // next slot index handed out to a producer (may overshoot SegmentSize)
+        std::atomic<std::size_t> users{0UZ};                           // producers currently operating on this segment
+        std::atomic<Segment*>    next{nullptr};
+        Segment*                 nextFree{nullptr};
+        alignas(kCacheLineSize) std::size_t consumed{0UZ}; // consumer-only read index
+        std::array<Slot, SegmentSize> slots;
+    };
+
+    alignas(kCacheLineSize) std::atomic<Segment*> _tail;       // producers
+    WaitSignal _pushSignal;                                    // consumer waiting for data parks here
+    alignas(kCacheLineSize) Segment*              _head;       // consumer only
+    std::vector<Segment*>                         _deferred;   // consumer only: exhausted segments still referenced by a producer
+    alignas(kCacheLineSize) std::atomic<Segment*> _freeList{nullptr}; // pushed by the consumer, popped by producers under '_growMutex'
+    std::mutex                                    _growMutex;
+    std::atomic<std::size_t>                      _segmentsAllocated{1UZ};
+    std::atomic<std::size_t>                      _segmentsRecycled{0UZ};
+    std::atomic<std::size_t>                      _liveSegments{1UZ};
+    std::atomic<std::size_t>                      _maxLiveSegments{1UZ};
+
+public:
+    struct Statistics {
+        std::size_t segmentsAllocated; // heap allocations
+        std::size_t segmentsRecycled;  // re-uses from the free list
+        std::size_t liveSegments;      // currently linked segments
+        std::size_t maxLiveSegments;   // peak number of simultaneously linked segments
+    };
+
+    SegmentedQueue() : _tail(new Segment), _head(_tail.load(std::memory_order_relaxed)) {}
+    SegmentedQueue(const SegmentedQueue&)            = delete;
+    SegmentedQueue& operator=(const SegmentedQueue&) = delete;
+    ~SegmentedQueue() noexcept { // N.B. requires that no producer or consumer accesses the queue anymore
+        for (Segment* segment = _head; segment != nullptr;) {
+            for (std::size_t i = segment->consumed; i < SegmentSize; ++i) {
+                if (segment->slots[i].ready.load(std::memory_order_acquire)) {
+                    segment->slots[i].storage.destroy();
+                }
+            }
+            delete std::exchange(segment, segment->next.load(std::memory_order_acquire));
+        }
+        for (Segment* segment : _deferred) {
+            delete segment;
+        }
+        for (Segment* segment = _freeList.load(std::memory_order_acquire); segment != nullptr;) {
+            delete std::exchange(segment, segment->nextFree);
+        }
+    }
+
+    static constexpr std::size_t segmentSize() noexcept { return SegmentSize; }
+
+    /// approximate number of queued elements at segment granularity, i.e. upper bound of the peak backlog
+    std::size_t highWaterMark() const noexcept { return _maxLiveSegments.load(std::memory_order_relaxed) * SegmentSize; }
+    Statistics  statistics() const noexcept { return {_segmentsAllocated.load(std::memory_order_relaxed), _segmentsRecycled.load(std::memory_order_relaxed), _liveSegments.load(std::memory_order_relaxed), _maxLiveSegments.load(std::memory_order_relaxed)}; }
+
+    /// consumer side: true if no element is ready at the front
+    bool empty() const noexcept {
+        const Segment* segment = _head;
+        if (segment->consumed == SegmentSize) {
+            segment = segment->next.load(std::memory_order_acquire);
+            return segment == nullptr || !segment->slots[0UZ].ready.load(std::memory_order_acquire);
+        }
+        return !segment->slots[segment->consumed].ready.load(std::memory_order_acquire);
+    }
+
+    /// N.B. a claimed slot must be published (the consumer waits for it): if T's constructor may throw, the element is built in a
+    /// temporary first and moved into the slot
+    template<typename... Args>
+    requires std::is_constructible_v<T, Args...>
+    bool emplace_back(Args&&... args) {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            return emplace_back(T(std::forward<Args>(args)...));
+        } else {
+            while (true) {
+                Segment* segment = acquireTail();
+                if (const std::size_t index = segment->claimed.fetch_add(1UZ, std::memory_order_relaxed); index < SegmentSize) {
+                    Slot& slot = segment->slots[index];
+                    slot.storage.construct(std::forward<Args>(args)...);
+                    slot.ready.store(true, std::memory_order_release);
+                    segment->users.fetch_sub(1UZ, std::memory_order_release);
+                    _pushSignal.notify_one();
+                    return true;
+                }
+                segment->users.fetch_sub(1UZ, std::memory_order_release);
+                grow(segment);
+            }
+        }
+    }
+
+    bool push_back(const T& item) { return emplace_back(item); }
+    bool push_back(T&& item) { return emplace_back(std::move(item)); }
+
+    /// pushes all elements, claiming as many consecutive slots per segment as possible with a single `fetch_add`
+    template<std::ranges::sized_range Range>
+    requires std::is_convertible_v<std::ranges::range_reference_t<Range>, const T&>
+    std::size_t push_range(Range&& items) {
+        using Source = RangeSource<Range>;
+        if constexpr (!std::is_nothrow_constructible_v<T, Source>) { // e.g. copies that allocate: one at a time, see emplace_back()
+            for (auto&& item : items) {
+                emplace_back(static_cast<Source>(item));
+            }
+            return static_cast<std::size_t>(std::ranges::size(items));
+        } else {
+            const std::size_t n  = static_cast<std::size_t>(std::ranges::size(items));
+            auto              it = std::ranges::begin(items);
+            for (std::size_t pushed = 0UZ; pushed < n;) {
+                Segment*          segment = acquireTail();
+                const std::size_t first   = segment->claimed.fetch_add(n - pushed, std::memory_order_relaxed);
+                const std::size_t last    = std::min(SegmentSize, first + (n - pushed));
+                for (std::size_t index = first; index < last; ++index, ++it, ++pushed) {
+                    Slot& slot = segment->slots[index];
+                    slot.storage.construct(rangeElement<Range>(it));
+                    slot.ready.store(true, std::memory_order_release);
+                }
+                segment->users.fetch_sub(1UZ, std::memory_order_release);
+                if (pushed < n) {
+                    grow(segment);
+                }
+            }
+            if (n > 0UZ) {
+                _pushSignal.notify_one();
+            }
+            return n;
+        }
+    }
+
+    /// consumer side (single thread)
+    std::optional<T> pop_front() {
+        Slot* slot = frontSlot();
+        if (slot == nullptr) {
+            return std::nullopt;
+        }
+        T item = slot->storage.take();
+        slot->ready.store(false, std::memory_order_relaxed);
+        ++_head->consumed;
+        return item;
+    }
+
+    /// consumer side (single thread): moves up to `out.size()` front elements into `out`
+    std::size_t pop_into(std::span<T> out) {
+        std::size_t n = 0UZ;
+        while (n < out.size()) {
+            Slot* slot = frontSlot();
+            if (slot == nullptr) {
+                break;
+            }
+            out[n++] = slot->storage.take();
+            slot->ready.store(false, std::memory_order_relaxed);
+            ++_head->consumed;
+        }
+        return n;
+    }
+
+    /// consumer side (single thread): blocking pop_front(), waits until an element arrives or `timeout` elapsed (default: no time limit)
+    template<typename Rep = std::int64_t, typename Period = std::nano>
+    std::optional<T> pop_front_wait(std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>::max()) {
+        std::optional<T> item;
+        _pushSignal.wait_until([&] { return (item = pop_front()).has_value(); }, atomic_wait::deadlineAfter(timeout));
+        return item;
+    }
+
+private:
+    // registers the calling producer as user of the current tail segment, the re-check guarantees the segment is not recycled meanwhile
+    Segment* acquireTail() noexcept {
+        while (true) {
+            Segment* segment = _tail.load(std::memory_order_acquire);
+            segment->users.fetch_add(1UZ, std::memory_order_seq_cst);
+            if (_tail.load(std::memory_order_seq_cst) == segment) {
+                return segment;
+            }
+            segment->users.fetch_sub(1UZ, std::memory_order_release);
+        }
+    }
+
+    // slow path: links a (recycled or new) segment behind 'full' unless another producer already did so
+    void grow(Segment* full) {
+        std::scoped_lock lock(_growMutex);
+        // N.B. the pointer alone is ambiguous (ABA): 'full' may have been retired, recycled and re-linked as a fresh tail since this
+        // producer found it exhausted. Recycling resets 'claimed' under this mutex, thus a tail that still has free slots is not full.
+        if (_tail.load(std::memory_order_relaxed) != full || full->claimed.load(std::memory_order_relaxed) < SegmentSize) {
+            return;
+        }
+        Segment* fresh = _freeList.load(std::memory_order_acquire);
+        while (fresh != nullptr && !_freeList.compare_exchange_weak(fresh, fresh->nextFree, std::memory_order_acquire)) {
+        }
+        if (fresh != nullptr) {
+            fresh->claimed.store(0UZ, std::memory_order_relaxed);
+            fresh->consumed = 0UZ;
+            fresh->next.store(nullptr, std::memory_order_relaxed);
+            _segmentsRecycled.fetch_add(1UZ, std::memory_order_relaxed);
+        } else {
+            fresh = new Segment;
+            _segmentsAllocated.fetch_add(1UZ, std::memory_order_relaxed);
+        }
+        const std::size_t live = _liveSegments.fetch_add(1UZ, std::memory_order_relaxed) + 1UZ;
+        if (live > _maxLiveSegments.load(std::memory_order_relaxed)) {
+            _maxLiveSegments.store(live, std::memory_order_relaxed);
+        }
+        full->next.store(fresh, std::memory_order_release);
+        _tail.store(fresh, std::memory_order_seq_cst);
+    }
+
+    // consumer side: returns the ready front slot (advancing/retiring exhausted head segments) or nullptr if none is ready
+    Slot* frontSlot() {
+        if (_head->consumed == SegmentSize) {
+            Segment* next = _head->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return nullptr;
+            }
+            retire(std::exchange(_head, next));
+        }
+        Slot& slot = _head->slots[_head->consumed];
+        return slot.ready.load(std::memory_order_acquire) ? &slot : nullptr;
+    }
+
+    void retire(Segment* segment) {
+        _liveSegments.fetch_sub(1UZ, std::memory_order_relaxed);
+        _deferred.push_back(segment);
+        std::erase_if(_deferred, [this](Segment* candidate) {
+            // once '_tail' has moved past 'candidate', producers registering from now on will back off (see acquireTail())
+            if (_tail.load(std::memory_order_seq_cst) == candidate || candidate->users.load(std::memory_order_seq_cst) != 0UZ) {
+                return false;
+            }
+            candidate->nextFree = _freeList.load(std::memory_order_relaxed);
+            while (!_freeList.compare_exchange_weak(candidate->nextFree, candidate, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+            return true;
+        });
+    }
+};
+
+#endif // SEGMENTEDQUEUE_HPP
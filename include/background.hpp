@@ -4,10 +4,13 @@
 #include <thread>
 #include <atomic>
 
+#include <AtomicWait.hpp>
+
 class BackgroundProcessor {
     void process();
     std::thread _thread;
     std::atomic<bool> _running;
+    WaitSignal _wakeUp; // interrupts the pause between iterations on stop()
 
 public:
     BackgroundProcessor();
@@ -0,0 +1,43 @@
+#ifndef DECOMPRESS_HPP
+#define DECOMPRESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <ByteBuffer.hpp>
+
+namespace file {
+
+enum class Compression : std::uint8_t { None = 0, Gzip, Zstd };
+
+/**
+ * @brief format of `data` by its magic bytes (gzip: `1f 8b 08` and valid header flags, zstd: `28 b5 2f fd` or a skippable frame),
+ * None otherwise
+ *
+ * N.B. the extension alone is not trusted: a '.gz' asset served with `Content-Encoding: gzip` arrives already inflated.
+ */
+[[nodiscard]] Compression detectCompression(std::span<const std::uint8_t> data) noexcept;
+
+/// `name` without a compression suffix ('.gz', '.gzip', '.zst', '.zstd'), e.g. "music.ogg.zst" -> "music.ogg"
+[[nodiscard]] std::string_view stripCompressionSuffix(std::string_view name) noexcept;
+
+/// false if built without the codec: gzip needs zlib (`HAVE_ZLIB`), zstd needs libzstd (`HAVE_ZSTD`)
+[[nodiscard]] bool canDecompress(Compression compression) noexcept;
+
+/**
+ * @brief streaming decompression of a complete gzip (incl. concatenated members) or zstd (incl. multiple frames) input
+ *
+ * The input is fed to the decoder in slices of `chunkSize` bytes and the decoder writes straight into the output buffer, which is
+ * allocated once (uninitialised) from the size recorded in the stream (gzip trailer, zstd frame header; clamped to 1 GiB, as it is
+ * untrusted input) and only grows geometrically if that hint falls short. Besides input and output only the decoder's window is
+ * alive (32 KiB for gzip, the frame's window size for zstd).
+ */
+[[nodiscard]] std::expected<ByteBuffer, std::string> decompress(std::span<const std::uint8_t> input, Compression compression, std::size_t chunkSize = 256UZ << 10);
+
+} // namespace file
+
+#endif // DECOMPRESS_HPP
@@ -1,24 +1,47 @@
 #ifndef FILE_IO_HPP
 #define FILE_IO_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <exception>
 #include <expected>
+#include <format>
+#include <fstream>
 #include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <print>
 #include <queue>
 #include <shared_mutex>
 #include <span>
+#include <stop_token>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <fstream>
 
+#include <AtomicWait.hpp>
+#include <BlobStore.hpp>
+#include <ByteBuffer.hpp>
 #include <EmscriptenHelper.hpp>
-#include <LockFreeQueue.hpp>
+#include <LruCache.hpp>
+#include <QueuePolicy.hpp>
+#include <Scheduler.hpp>
+#include <http_client.hpp>
+#include <io_pool.hpp>
+#include <url_cache.hpp>
+#include <write_behind.hpp>
 
 namespace file {
 
@@ -30,56 +53,253 @@ concept ChronoDuration = requires {
 };
 
 struct FileData {
-    std::size_t          requestID;
-    std::string          name;
-    std::vector<uint8_t> data;
+    std::size_t              requestID;
+    std::string              name;
+    ByteBuffer               data;             // shared, immutable: copying a FileData does not copy the payload
+    std::chrono::nanoseconds decompressTime{}; // spent on a worker inflating `data` (see FileIo::enableDecompression()), zero if loaded as is
+};
+
+/**
+ * @brief splits an upload buffer into FileData entries whose `data` are slices of (i.e. share ownership of) `buffer`
+ *
+ * Buffer Layout (binary format, little-endian):
+ *   [uint32_t numFiles]
+ *   For each file:
+ *     [uint32_t nameLength]
+ *     [uint32_t dataLength]
+ *     [uint8_t nameBytes[nameLength]]   (UTF-8 encoded filename)
+ *     [uint8_t fileData[dataLength]]    (raw file content)
+ * @throws std::runtime_error if the buffer is truncated
+ */
+std::vector<FileData> parseUploadedFiles(std::size_t requestID, const ByteBuffer& buffer);
+
+/// one fixed-size piece of a streamed file, `data` is at most the stream's chunk size (the last chunk of a file may be shorter)
+struct FileChunk {
+    std::size_t   requestID;
+    std::size_t   fileIndex; // index of the file within a (multi-file) stream
+    std::string   name;
+    std::uint64_t offset;   // byte offset of 'data' within the file (64-bit: streamed files may exceed 4 GiB on wasm32)
+    std::uint64_t fileSize; // total size of the file
+    ByteBuffer    data;
+    bool          last; // last chunk of this file
+};
+
+/**
+ * @brief shared producer/consumer state of a FileStream
+ *
+ * Chunks travel through a bounded queue of `kDepth` entries: a producer that runs ahead of its consumer stalls (native: blocks,
+ * WASM: the JS reader polls `room()` before reading the next slice), i.e. at most `kDepth + 1` chunk buffers are alive per stream.
+ */
+struct StreamState {
+    static constexpr std::size_t kDepth        = 4UZ;
+    static constexpr auto        kPollInterval = std::chrono::milliseconds(50);
+
+    std::size_t                                                streamID;
+    std::size_t                                                chunkSize;
+    PolicyQueue<FileChunk, kDepth, QueuePolicy::MultiProducer> chunks;
+    WaitSignal                                                 progress; // notified on every delivered chunk and on finish()
+    std::atomic<std::uint64_t>                                 bytesTotal{0U};
+    std::atomic<std::uint64_t>                                 bytesQueued{0U};
+    std::atomic<std::uint64_t>                                 bytesConsumed{0U};
+    std::atomic<std::size_t>                                   chunksConsumed{0UZ};
+    std::atomic<bool>                                          cancelled{false};
+    std::atomic<bool>                                          finished{false};
+    std::string                                                error; // written before 'finished' is set, empty on success
+
+    StreamState(std::size_t id, std::size_t size) : streamID(id), chunkSize(size) {}
+
+    /// free queue slots, negative once the consumer cancelled or dropped the stream
+    [[nodiscard]] int room() const noexcept { return cancelled.load(std::memory_order_acquire) ? -1 : static_cast<int>(kDepth - std::min(kDepth, chunks.size())); }
+
+    /// non-blocking producer side, fails if the queue is full
+    bool tryDeliver(FileChunk&& chunk) {
+        const std::size_t nBytes = chunk.data.size();
+        if (!chunks.push_back(std::move(chunk))) {
+            return false;
+        }
+        bytesQueued.fetch_add(nBytes, std::memory_order_relaxed);
+        progress.notify_all();
+        return true;
+    }
+
+    /// blocking producer side (not on the WASM main thread): waits for a free slot, returns false if the stream was cancelled meanwhile
+    bool deliver(FileChunk&& chunk) {
+        while (!cancelled.load(std::memory_order_acquire)) {
+            const std::size_t nBytes = chunk.data.size();
+            if (chunks.push_back_wait(std::move(chunk), kPollInterval)) {
+                bytesQueued.fetch_add(nBytes, std::memory_order_relaxed);
+                progress.notify_all();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void finish(std::string errorMsg = {}) {
+        error = std::move(errorMsg);
+        finished.store(true, std::memory_order_release);
+        progress.notify_all();
+    }
+};
+
+/**
+ * @brief consumer handle of a chunked file stream created by FileIo::loadFileStream(), cancels the producer when destroyed
+ *
+ * @code
+ * file::FileStream stream = file::FileIo::instance().loadFileStream("capture.bin", 4UZ << 20);
+ * while (auto chunk = stream.next_wait(std::chrono::seconds(1))) { // or non-blocking next() from the render loop
+ *     process(chunk->data);
+ *     auto [read, total, nChunks] = stream.progress();
+ * }
+ * if (stream.done() && !stream.error().empty()) { ... }
+ * @endcode
+ */
+class FileStream {
+    std::shared_ptr<StreamState> _state;
+
+    std::optional<FileChunk> pop() {
+        auto chunk = _state->chunks.pop_front();
+        if (chunk) {
+            _state->bytesConsumed.fetch_add(chunk->data.size(), std::memory_order_relaxed);
+            _state->chunksConsumed.fetch_add(1UZ, std::memory_order_relaxed);
+        }
+        return chunk;
+    }
+
+public:
+    struct Progress {
+        std::uint64_t bytesConsumed;
+        std::uint64_t bytesTotal; // 0 if not (yet) known
+        std::size_t   chunksConsumed;
+    };
+
+    explicit FileStream(std::shared_ptr<StreamState> state) : _state(std::move(state)) {}
+    FileStream(const FileStream&)            = delete;
+    FileStream& operator=(const FileStream&) = delete;
+    FileStream(FileStream&&) noexcept        = default;
+    FileStream& operator=(FileStream&& other) noexcept {
+        if (this != &other) {
+            cancel();
+            _state = std::move(other._state);
+        }
+        return *this;
+    }
+    ~FileStream() noexcept { cancel(); }
+
+    [[nodiscard]] std::size_t requestID() const noexcept { return _state->streamID; }
+    [[nodiscard]] std::size_t chunkSize() const noexcept { return _state->chunkSize; }
+
+    /// non-blocking, safe to call from the WASM main thread
+    [[nodiscard]] std::optional<FileChunk> next() { return pop(); }
+
+    /// blocking next(): waits until a chunk arrives, the stream finished or `timeout` elapsed
+    template<typename Rep = std::int64_t, typename Period = std::nano>
+    [[nodiscard]] std::optional<FileChunk> next_wait(std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>::max()) {
+        std::optional<FileChunk> chunk;
+        _state->progress.wait_until([&] { return (chunk = pop()).has_value() || _state->finished.load(std::memory_order_acquire); }, atomic_wait::deadlineAfter(timeout));
+        return chunk ? std::move(chunk) : pop(); // re-check: the last chunk may have been queued right before 'finished'
+    }
+
+    /// true once the producer finished (successfully or not) and all chunks have been consumed
+    [[nodiscard]] bool             done() const noexcept { return _state && _state->finished.load(std::memory_order_acquire) && _state->chunks.empty(); }
+    [[nodiscard]] std::string_view error() const noexcept { return _state && _state->finished.load(std::memory_order_acquire) ? std::string_view(_state->error) : std::string_view{}; }
+    [[nodiscard]] Progress         progress() const noexcept { return {_state->bytesConsumed.load(std::memory_order_relaxed), _state->bytesTotal.load(std::memory_order_relaxed), _state->chunksConsumed.load(std::memory_order_relaxed)}; }
+
+    void cancel() noexcept {
+        if (_state) {
+            _state->cancelled.store(true, std::memory_order_release);
+        }
+    }
 };
 
 class Request {
     using DataStoreType = std::expected<std::vector<FileData>, std::string>;
 
     struct SharedState {
-        std::size_t              requestID{0UZ};
-        DataStoreType            result{std::unexpected("initialised")};
-        std::atomic<std::size_t> pendingUsers{1UZ};
+        std::size_t                                              requestID{0UZ};
+        DataStoreType                                            result{std::unexpected("initialised")};
+        std::atomic<bool>                                        completed{false}; // set (release) once 'result' is final
+        std::atomic<bool>                                        cancelled{false}; // set by FileIo::cancel(), polled by the loaders
+        std::atomic<bool>                                        observed{false};  // a then()/co_await consumer takes the result -> no mailbox
+        std::size_t                                              handles{1UZ};     // loadFile() calls that returned it (joins), guarded by FileIo::_assetMutex
+        WaitSignal                                               completion;       // wakes wait()/wait_for()/wait_until()
+        std::mutex                                               continuationMutex;
+        std::vector<std::pair<Executor, std::function<void()>>> continuations; // guarded by 'continuationMutex'
     };
 
     std::shared_ptr<SharedState> _state = std::make_shared<SharedState>();
 
-    void complete(std::vector<FileData> files) { _state->result = std::move(files); }
-    void completeWithError(std::string errorMsg) { _state->result = std::unexpected(std::move(errorMsg)); }
+    [[nodiscard]] CancelFlag cancelFlag() const { return CancelFlag(_state, &_state->cancelled); } // aliases the shared state
 
-public:
-    Request() = delete;
+    void complete(std::vector<FileData> files) {
+        _state->result = std::move(files);
+        settle();
+    }
+    void completeWithError(std::string errorMsg) {
+        _state->result = std::unexpected(std::move(errorMsg));
+        settle();
+    }
 
-    explicit Request(std::size_t requestID) : _state(std::make_shared<SharedState>(requestID)) {}
+    // hands the registered continuations to the Scheduler, N.B. never runs them inline: complete() is called under FileIo's locks
+    void settle() {
+        std::vector<std::pair<Executor, std::function<void()>>> continuations;
+        {
+            std::scoped_lock lock(_state->continuationMutex);
+            _state->completed.store(true, std::memory_order_release);
+            continuations.swap(_state->continuations);
+        }
+        _state->completion.notify_all();
+        for (auto& [executor, continuation] : continuations) {
+            Scheduler::instance().post(executor, std::move(continuation));
+        }
+    }
 
-    Request(const Request& other) noexcept : _state(other._state) { _state->pendingUsers.fetch_add(1UZ, std::memory_order_relaxed); }
-    Request(Request&& other) = default;
+    static void observe(const std::shared_ptr<SharedState>& state); // releases the request's FileIo mailbox (if any) on first use
 
-    Request& operator=(const Request& other) noexcept {
-        if (this != &other) {
-            _state->pendingUsers.fetch_sub(1UZ, std::memory_order_relaxed);
-            _state = other._state;
-            _state->pendingUsers.fetch_add(1UZ, std::memory_order_relaxed);
+    static void addContinuation(const std::shared_ptr<SharedState>& state, Executor executor, std::function<void()> continuation) {
+        {
+            std::scoped_lock lock(state->continuationMutex);
+            if (!state->completed.load(std::memory_order_relaxed)) { // the mutex orders it w.r.t. settle()
+                state->continuations.emplace_back(executor, std::move(continuation));
+                return;
+            }
         }
-        return *this;
+        Scheduler::instance().post(executor, std::move(continuation)); // already completed
     }
 
-    Request& operator=(Request&& other) noexcept {
-        if (this != &other) {
-            _state->pendingUsers.fetch_sub(1UZ, std::memory_order_relaxed);
-            _state = std::move(other._state);
-            // no increment needed
+    struct Awaiter {
+        std::shared_ptr<SharedState> state;
+        Executor                     executor;
+
+        bool          await_ready() const noexcept { return false; } // always resume on 'executor', even if already completed
+        void          await_suspend(std::coroutine_handle<> handle) {
+            observe(state);
+            addContinuation(state, executor, [handle] { handle.resume(); });
         }
+        DataStoreType await_resume() const { return state->result; } // copy: cheap (shared ByteBuffers), other owners keep theirs
+    };
+
+public:
+    Request() = delete;
+
+    explicit Request(std::size_t requestID) : _state(std::make_shared<SharedState>(requestID)) {}
+
+    /**
+     * @brief registers `continuation(result)` to run on `executor` once the request completed (immediately scheduled if it already
+     * has), `result` being the `std::expected<std::vector<FileData>, std::string>` also returned by get(). Multiple continuations
+     * per request are allowed and run independently (possibly concurrently), thus `result` is passed as const reference.
+     */
+    template<typename Continuation>
+    requires std::is_invocable_v<Continuation, const DataStoreType&>
+    Request& then(Continuation&& continuation, Executor executor = Executor::MainThread) {
+        observe(_state);
+        addContinuation(_state, executor, [state = _state, f = std::forward<Continuation>(continuation)]() mutable { f(std::as_const(state->result)); });
         return *this;
     }
 
-    ~Request() noexcept {
-        if (_state && _state->pendingUsers.fetch_sub(1UZ, std::memory_order_acq_rel) == 2UZ) {
-            _state->pendingUsers.notify_all();
-        }
-    }
+    /// `co_await request` resumes the coroutine on the main thread (see Scheduler::runMainThreadTasks()), `co_await request.on(Executor::Worker)` on a worker
+    [[nodiscard]] Awaiter on(Executor executor) const { return Awaiter{_state, executor}; }
+    [[nodiscard]] Awaiter operator co_await() const { return on(Executor::MainThread); }
 
     std::size_t requestID() const noexcept { return _state->requestID; }
     std::size_t refCount() const noexcept { return _state.use_count(); }
@@ -92,124 +312,377 @@ public:
         return _state->result;
     }
 
-    template<ChronoDuration DurationType = std::chrono::milliseconds>
-    bool wait(DurationType timeout = std::chrono::milliseconds(0), std::size_t divider = 10UZ) const {
-        std::size_t initialRefCount = refCount();
-        if (initialRefCount == 1UZ) {
-            return true;
-        }
+    /// non-blocking: true once the request completed (successfully or with an error), get() may then be read from any thread
+    [[nodiscard]] bool ready() const noexcept { return _state->completed.load(std::memory_order_acquire); }
 
-        if (timeout.count() == 0 && !isMainThread()) {
-            // wait indefinitely or until new data arrived
-            std::size_t expected = _state->pendingUsers.load(std::memory_order_relaxed);
-            while (expected == initialRefCount) {
-                _state->pendingUsers.wait(expected, std::memory_order_relaxed);
-                expected = _state->pendingUsers.load(std::memory_order_relaxed);
-            }
+    /**
+     * @brief abandons the load: completes the request with the error "cancelled", aborts the transfer (emscripten_fetch, native
+     * HTTP, queued or io_uring file reads) and drops a result arriving late before its buffer is allocated.
+     * N.B. affects every holder of the request, incl. loadFile() calls that joined it. Returns false if it had already completed.
+     */
+    bool cancel();
+
+    /// deadline: the request is cancelled with the error "deadline exceeded" unless it completed by then
+    Request& cancelAt(std::chrono::steady_clock::time_point deadline);
+
+    template<typename Rep, typename Period>
+    Request& cancelAfter(std::chrono::duration<Rep, Period> timeout) {
+        return cancelAt(std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(timeout));
+    }
+
+    [[nodiscard]] bool cancelled() const noexcept { return _state->cancelled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief blocks until the request completed or `deadline` passed, waiters park on a futex and are woken by the completing thread
+     * On the WASM main thread this never blocks (Atomics.wait is not permitted there) and is equivalent to ready().
+     * @return ready()
+     */
+    template<typename Clock, typename Duration>
+    bool wait_until(std::chrono::time_point<Clock, Duration> deadline) const {
+        return ready() || _state->completion.wait_until([this] { return ready(); }, deadline);
+    }
+
+    template<typename Rep, typename Period>
+    bool wait_for(std::chrono::duration<Rep, Period> timeout) const {
+        return wait_until(atomic_wait::deadlineAfter(timeout));
+    }
+
+    /// waits indefinitely for a zero `timeout` (default), otherwise like wait_for(timeout)
+    template<ChronoDuration DurationType = std::chrono::milliseconds>
+    bool wait(DurationType timeout = std::chrono::milliseconds(0)) const {
+        if (ready()) {
             return true;
         }
-
-        if (timeout.count() == 0 && isMainThread()) {
+        if (!atomic_wait::mayBlock()) {
             std::println(stderr, "[WARNING] called wait() in main WASM thread -> returning false");
             return false;
         }
+        return timeout.count() == 0 ? wait_until(std::chrono::steady_clock::time_point::max()) : wait_for(timeout);
+    }
 
-        auto start = std::chrono::steady_clock::now();
-        auto slice = timeout / divider;
+    friend class FileIo;
+};
 
-        while (true) {
-            if (refCount() == 1UZ) {
-                return true;
-            }
+/// one entry of FileIo::loadBatch(): higher `priority` is dispatched first, equal priorities in submission order
+struct BatchSource {
+    std::string source; // URL or local path (the browser picker is not supported in batches)
+    int         priority = 0;
+    LoadMode    mode     = LoadMode::Auto;
+};
 
-            std::println("waiting for: {}", slice.count());
-            std::this_thread::yield();
-            std::this_thread::sleep_for(slice);
+/**
+ * @brief handle of a FileIo::loadBatch(): one Request per source (input order) plus two combined Requests
+ *
+ * - `when_all()` completes once every source completed: with the files of all sources in input order, or with the collected
+ *   error messages if any source failed
+ * - `when_any()` completes with the files of the first source that loaded successfully, or with an error if all of them failed
+ * All of them support ready()/wait_for()/then()/co_await like any other Request. Cancelling a source's Request (cancel(),
+ * cancelAt()) completes it with the error and, once dispatched, cancels its underlying load unless other loadFile() calls share that
+ * load (joined in-flight loads): then only the item is detached and the shared load continues for them.
+ *
+ * @code
+ * auto batch = file::FileIo::instance().loadBatch({{"thumbs/a.png", 10}, {"thumbs/b.png", 10}, {"data/volume.raw", 0}});
+ * batch.when_any().then([](auto& first) { showPreview(first); });
+ * co_await batch.when_all();
+ * @endcode
+ */
+class Batch {
+    struct State {
+        std::vector<Request>                items;
+        std::vector<std::optional<Request>> loads;   // underlying loadFile() of each dispatched item (guarded by FileIo::_batchMutex)
+        std::vector<std::atomic<bool>>      settled; // per item: completed, either by its load or by cancel() before that
+        Request                             all;
+        Request                             any;
+        std::atomic<std::size_t>            remaining;
+        std::atomic<bool>                   anySettled{false};
+
+        State(std::vector<Request> items_, Request all_, Request any_) : items(std::move(items_)), loads(items.size()), settled(items.size()), all(std::move(all_)), any(std::move(any_)), remaining(items.size()) {}
+    };
 
-            if ((std::chrono::steady_clock::now() - start) >= timeout) {
-                return false; // timeout
-            }
-        }
-    }
+    std::shared_ptr<State> _state;
+
+    explicit Batch(std::shared_ptr<State> state) : _state(std::move(state)) {}
+
+public:
+    [[nodiscard]] std::size_t size() const noexcept { return _state->items.size(); }
+    [[nodiscard]] std::size_t completed() const noexcept { return size() - _state->remaining.load(std::memory_order_acquire); }
+    [[nodiscard]] Request&    operator[](std::size_t index) const { return _state->items.at(index); }
+    [[nodiscard]] Request     when_all() const { return _state->all; }
+    [[nodiscard]] Request     when_any() const { return _state->any; }
 
     friend class FileIo;
 };
 
+/// frame-time metrics of FileIo::processPendingWrites()
+struct WriteDrainStatistics {
+    std::size_t               backlog; // queued writes at the start of the last call
+    std::size_t               peakBacklog;
+    std::size_t               lastDrained; // writes performed by the last call
+    std::chrono::microseconds lastDrainTime;
+    std::chrono::microseconds maxDrainTime;
+    std::size_t               deferred; // calls that hit the budget and left writes for later frames
+};
+
 using HttpLoadCallback   = std::function<std::vector<FileData>(std::size_t requestID, std::string_view path, std::string_view accept, bool multipleFiles)>;
 using FileDialogCallback = std::function<std::vector<FileData>(std::size_t requestID, std::string_view path, std::string_view accept, bool multipleFiles)>;
 
 class FileIo {
-    std::atomic<std::size_t>    _requestID     = {0UZ};
-    std::atomic<std::size_t>    _updateCounter = {0UZ};
-    LockFreeQueue<FileData, 64> _uploadedFiles;
-    LockFreeQueue<FileData, 64> _pendingWrites;
-    HttpLoadCallback            _httpLoader = [this](std::size_t requestID, std::string_view url, std::string_view /*accept*/, bool /*multipleFiles*/) { return this->triggerHttpLoad(requestID, url); };
-    FileDialogCallback          _fileDialog = [this](std::size_t requestID, std::string_view /*path*/, std::string_view accept, bool multipleFiles) { return this->triggerFileUpload(requestID, accept, multipleFiles); };
+    // uploads are pushed from browser callbacks (main thread) and from loadFile() callers on arbitrary threads and must never be
+    // dropped (folder uploads easily exceed a fixed capacity), pending writes from writeFile<Async>() on any worker thread
+    static constexpr QueuePolicy kUploadQueuePolicy  = QueuePolicy::Unbounded;
+    static constexpr QueuePolicy kWriteQueuePolicy   = QueuePolicy::MultiProducer;
+    static constexpr auto        kWriteQueueTimeout  = std::chrono::seconds(5);
+    static constexpr std::size_t kPollBatchSize      = 64UZ;
+    static constexpr std::size_t kMailboxSegmentSize = 8UZ;
+
+    /// per-request delivery slot: filled by pushUploadedFiles(), drained by pollUploadedFile() without touching other requests
+    struct Mailbox {
+        std::size_t                                                    sequence; // creation order -> poll-all delivery order
+        PolicyQueue<FileData, kMailboxSegmentSize, kUploadQueuePolicy> files;
+        std::atomic_flag                                               draining; // single-consumer guard for 'files'
+
+        explicit Mailbox(std::size_t sequence_) : sequence(sequence_) {}
+    };
+
+    std::atomic<std::size_t>                         _requestID     = {0UZ};
+    std::atomic<std::size_t>                         _updateCounter = {0UZ};
+    PolicyQueue<FileData, 64UZ, kWriteQueuePolicy>   _pendingWrites;
+    HttpLoadCallback                                 _httpLoader = [this](std::size_t requestID, std::string_view url, std::string_view /*accept*/, bool /*multipleFiles*/) { return this->triggerHttpLoad(requestID, url); };
+    FileDialogCallback                               _fileDialog = [this](std::size_t requestID, std::string_view /*path*/, std::string_view accept, bool multipleFiles) { return this->triggerFileUpload(requestID, accept, multipleFiles); };
 
     std::vector<FileData> triggerHttpLoad(std::size_t requestID, std::string_view url);
     std::vector<FileData> triggerFileUpload(std::size_t requestID, std::string_view accept, bool multipleFiles);
+    void                  failRequest(std::size_t requestID, std::string errorMsg);
+    CancelFlag            cancelFlagOf(std::size_t requestID); // an already set flag if the request is no longer pending
+
+    Request                  startLoad(std::string_view source, std::string_view acceptedFileExtensions, bool acceptMultipleFiles, LoadMode mode, ByteRange range);
+    std::optional<ByteRange> takeRange(std::size_t requestID); // for loaders that apply the window themselves
+
+    // payload of a queued write: shares a ByteBuffer, adopts an rvalue vector, copies anything else
+    template<typename Data>
+    static ByteBuffer toByteBuffer(Data&& data) {
+        using Type = std::remove_cvref_t<Data>;
+        if constexpr (std::same_as<Type, ByteBuffer>) {
+            return std::forward<Data>(data);
+        } else if constexpr (std::same_as<Type, std::vector<std::uint8_t>> && !std::is_lvalue_reference_v<Data>) {
+            return ByteBuffer(std::move(data));
+        } else {
+            const auto bytes = std::as_bytes(std::span(std::ranges::data(data), std::ranges::size(data))); // e.g. std::string payloads
+            return ByteBuffer::copyOf(std::span(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size()));
+        }
+    }
+#ifndef __EMSCRIPTEN__
+    http::Client _httpClient; // default native HTTP backend (keep-alive, per-host connection pool)
+#endif
 
-    std::mutex                               _requestsMutex;
-    std::unordered_map<std::size_t, Request> _pendingRequests;
+    struct Stages { // run on a worker between loading and delivery
+        bool decompress;
+        bool deduplicate;
+    };
 
-    FileIo() = default; // use instance() singleton
-public:
-    [[maybe_unused]] Request loadFile(std::string_view source = {}, std::string_view acceptedFileExtensions = "", bool acceptMultipleFiles = true); // empty source launches browser picker
-    void                     pushUploadedFiles(std::vector<FileData> files) noexcept {
-        bool found = false;
-        {
-            std::scoped_lock lock(_requestsMutex);
-            if (auto it = _pendingRequests.find(files[0UZ].requestID); it != _pendingRequests.end()) {
-                std::println("pushUploadedFiles: Matching request for ID {}", files[0UZ].requestID);
-                it->second.complete(files);
-                // Request request = it->second;
-                _pendingRequests.erase(it);
-                found = true;
-            } else {
-                std::println("pushUploadedFiles: No matching request for ID {}", files[0UZ].requestID);
-                return;
-            }
-        }
+    std::mutex                                 _requestsMutex;
+    std::unordered_map<std::size_t, Request>   _pendingRequests;
+    std::unordered_map<std::size_t, ByteRange> _ranges; // picker/URL loads of loadFileRange() not yet windowed
+    std::unordered_map<std::size_t, Stages>    _stages; // loads with worker stages that have not run yet
+    std::atomic<bool>                          _decompress{false};
+    std::atomic<bool>                          _deduplicate{true};
+    BlobStore                                  _blobStore;
 
-        for (FileData& file : files) {
-            _uploadedFiles.push_back(std::move(file));
-            _updateCounter.fetch_add(1UZ, std::memory_order_relaxed);
-            _updateCounter.notify_all();
-        }
+    void runStages(std::vector<FileData> files, Stages stages); // on a worker, then pushUploadedFiles() of the processed files
 
-        std::println("pushUploadedFiles: notify file upload: {} - counter: {} found: {}", files[0].name, _updateCounter.load(), found);
-    }
+    std::shared_mutex                                         _mailboxMutex; // shared: lookup + push, exclusive: create/erase
+    std::unordered_map<std::size_t, std::shared_ptr<Mailbox>> _mailboxes;
+    std::map<std::size_t, std::size_t>                        _deliveries; // mailbox sequence -> request ID (for the poll-all view)
+    std::size_t                                               _mailboxSequence{0UZ};
+    std::atomic_flag                                          _pollingAll; // single-consumer guard for the poll-all view
+    std::atomic<std::size_t>                                  _mailboxHighWaterMark{0UZ};
 
-    [[nodiscard]] std::vector<FileData> pollUploadedFile(std::optional<std::size_t> requestID = std::nullopt) noexcept {
-        std::vector<FileData> matches;
-
-        std::optional<FileData> file = _uploadedFiles.pop_front();
-        if (requestID.has_value()) {
-            std::deque<FileData> nonMatching;
-            for (; file.has_value(); file = _uploadedFiles.pop_front()) {
-                if (file->requestID == *requestID) {
-                    matches.push_back(std::move(*file));
-                } else {
-                    // non-matching file -> back into the queue
-                    nonMatching.push_back(std::move(*file));
-                }
-            }
-            for (auto& nonMatchingFile : nonMatching) {
-                _uploadedFiles.push_back(std::move(nonMatchingFile));
-            }
-        } else {
-            // get all
-            for (; file.has_value(); file = _uploadedFiles.pop_front()) {
-                matches.push_back(std::move(*file));
-            }
-        }
+    std::size_t drainMailbox(std::size_t requestID, std::vector<FileData>& out); // appends to 'out', returns the number of files drained
+    void        releaseMailbox(std::size_t requestID);                           // drops undrained files, e.g. consumed via then()/co_await
+    friend class Request; // Request::observe() -> releaseMailbox()
 
-        return matches;
-    }
+    std::mutex                                                  _streamsMutex;
+    std::unordered_map<std::size_t, std::weak_ptr<StreamState>> _streams; // open browser-picker streams, looked up by the JS glue
+
+    void triggerStreamUpload(std::size_t streamID, std::size_t chunkSize, std::string_view accept, bool multipleFiles);
+
+    mutable std::mutex        _urlCacheMutex;
+    std::shared_ptr<UrlCache> _urlCache; // optional, consulted by triggerHttpLoad()
+
+    using AssetCache = LruCache<std::string, std::vector<FileData>>;
+
+    std::mutex                                   _assetMutex;
+    AssetCache                                   _assetCache{kDefaultAssetCacheBudget}; // key: normalised source, cost: bytes
+    std::unordered_map<std::string, Request>     _inFlight;                             // key: normalised source
+    std::unordered_map<std::size_t, std::string> _inFlightKeys;                         // requestID -> key
+    std::size_t                                  _coalesced = 0UZ;
+
+    void settleInFlight(std::size_t requestID, const std::vector<FileData>* files); // files == nullptr: failed, nothing is cached
+
+    struct BatchJob {
+        int                           priority;
+        std::size_t                   sequence; // FIFO among equal priorities
+        std::string                   source;
+        LoadMode                      mode;
+        std::shared_ptr<Batch::State> batch;
+        std::size_t                   index;
+
+        bool operator<(const BatchJob& other) const noexcept { return priority != other.priority ? priority < other.priority : sequence > other.sequence; }
+    };
+
+    std::mutex                                                                            _batchMutex;
+    std::priority_queue<BatchJob>                                                         _batchQueue; // shared by all batches: high-priority sources of a later batch overtake bulk data
+    std::unordered_map<std::size_t, std::pair<std::shared_ptr<Batch::State>, std::size_t>> _batchItems; // item requestID -> {batch, index} until completed (item requests are not in _pendingRequests)
+    std::size_t                                                                           _batchSequence    = 0UZ;
+    std::size_t                                                                           _batchActive      = 0UZ;
+    std::size_t                                                                           _batchConcurrency = kDefaultBatchConcurrency;
+
+    void dispatchBatchJobs();
+    bool completeBatchItem(const std::shared_ptr<Batch::State>& batch, std::size_t index, const Request::DataStoreType& result); // false if already completed
+    bool cancelBatchItem(std::size_t requestID, std::string reason);
+
+    using Deadline = std::pair<std::chrono::steady_clock::time_point, std::size_t>; // requestID
+
+    std::mutex                                                           _deadlineMutex;
+    std::condition_variable_any                                          _deadlineChanged;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> _deadlines;        // earliest first, completed requests are skipped when due
+    std::jthread                                                         _deadlineWatchdog; // started by the first cancelAt()
+
+    void runDeadlineWatchdog(std::stop_token stop);
+
+    WriteDrainStatistics _drainStatistics{}; // main thread only, see processPendingWrites()
+
+    std::mutex                   _writeBehindMutex;
+    WriteBehind::Options         _writeBehindOptions;
+    std::unique_ptr<WriteBehind> _writeBehind; // created on first native writeFile(), drains its queue on destruction
+
+    WriteBehind& writeBehind();
 
+    std::mutex              _ioPoolMutex;
+    std::size_t             _ioQueueDepth = IoPool::kDefaultQueueDepth;
+    std::unique_ptr<IoPool> _ioPool; // created on first native path load, N.B. declared last: joins its threads before the rest is destroyed
+
+    IoPool& ioPool();
+
+    // use instance() singleton, N.B. constructs the Scheduler singleton first so that it is destroyed after FileIo: the I/O
+    // threads joined by ~FileIo() may still complete requests, which posts their continuations to the Scheduler
+    FileIo() { (void)Scheduler::instance(); }
+public:
+    static constexpr std::size_t kDefaultAssetCacheBudget = 32UZ << 20; // 32 MiB
+
+    struct AssetCacheStatistics {
+        AssetCache::Statistics cache;
+        std::size_t            coalesced; // loadFile() calls that joined an in-flight load of the same source
+        std::size_t            inFlight;
+    };
+
+    /**
+     * @brief loads `source`: empty -> browser picker, http(s) URL -> HTTP loader, otherwise a local path
+     *
+     * URL and path loads are memoised by normalised source: a source that is still loading returns the in-flight Request (same
+     * requestID, the files are delivered once), a completed one is served from an in-memory LRU of `setAssetCacheBudget()` bytes
+     * whose FileData share their (immutable) buffers with every other user. Use `invalidateAsset()` after modifying a local file other than through `writeFile()`.
+     */
+    [[maybe_unused]] Request loadFile(std::string_view source = {}, std::string_view acceptedFileExtensions = "", bool acceptMultipleFiles = true, LoadMode mode = LoadMode::Auto);
+
+    /**
+     * @brief partial loadFile(): only `range` of the source is read (clamped to its size), e.g. a container header or the first
+     * seconds of a recording. Local paths use positioned reads (LoadMode::Map: a mapping of which only the window is touched),
+     * URLs an HTTP `Range` request (servers without range support send the whole body, which is then windowed) and picked files
+     * `File.slice()`. Each FileData holds the window's bytes, ranged loads are memoised per source and window.
+     */
+    [[maybe_unused]] Request loadFileRange(std::string_view source, ByteRange range, std::string_view acceptedFileExtensions = "", bool acceptMultipleFiles = true, LoadMode mode = LoadMode::Auto);
+    void                     pushUploadedFiles(std::vector<FileData> files) noexcept;
+
+    /// see Request::cancel(), `reason` becomes the request's error, returns false if `requestID` is not pending (anymore)
+    bool cancel(std::size_t requestID, std::string reason = "cancelled");
+    void cancelAt(std::size_t requestID, std::chrono::steady_clock::time_point deadline); // see Request::cancelAt()
+
+    static constexpr std::size_t kDefaultBatchConcurrency = 6UZ; // browsers' HTTP/1.1 connections per host
+
+    /**
+     * @brief loads many sources through a priority queue with at most `setBatchConcurrency()` loads of all batches in flight
+     * (instead of firing every loadFile() at once), see Batch. Returns immediately.
+     */
+    [[nodiscard]] Batch loadBatch(std::vector<BatchSource> sources);
+    void                setBatchConcurrency(std::size_t maxConcurrent); // clamped to >= 1
+
+    void                               setAssetCacheBudget(std::size_t bytes); // 0: no caching (in-flight loads are still shared)
+    void                               invalidateAsset(std::string_view source);
+    [[nodiscard]] AssetCacheStatistics assetCacheStatistics();
+
+    static constexpr std::size_t kDefaultChunkSize = 4UZ << 20; // 4 MiB
+
+    /// number of concurrent native path loads (thread pool) or block reads (io_uring), see IoPool
+    void setIoQueueDepth(std::size_t depth);
+
+    /**
+     * @brief transparent decompression of gzip/zstd sources (off by default): whole-file loadFile() results whose magic bytes show
+     * a compressed stream are inflated on a Scheduler worker before the request completes, thus consumers, the asset cache and
+     * joined loads see the decoded bytes. A '.gz'/'.zst' suffix is dropped from `FileData::name`, the time spent is reported in
+     * `FileData::decompressTime`. Ranged loads and streams are delivered as loaded, so are payloads of codecs not built in (see
+     * canDecompress(), e.g. zstd on WASM) and payloads that fail to decode (logged). Applies to loads started afterwards.
+     */
+    void enableDecompression(bool enable = true) { _decompress.store(enable, std::memory_order_relaxed); }
+
+    /**
+     * @brief content-addressed sharing of identical payloads (see BlobStore, on by default): picker and URL loads are interned on
+     * a worker before delivery, thus re-uploads of the same content share one buffer. deduplicate() interns any other payload,
+     * e.g. generated exports before writeFile(). Applies to loads started afterwards.
+     */
+    void                                enableDeduplication(bool enable = true) { _deduplicate.store(enable, std::memory_order_relaxed); }
+    [[nodiscard]] ByteBuffer            deduplicate(ByteBuffer data) { return _blobStore.intern(std::move(data)); }
+    [[nodiscard]] BlobStore::Statistics blobStoreStatistics() const { return _blobStore.statistics(); }
+
+    /// persistent cache for URL loads through the default HTTP loader (off by default, see UrlCache), replaces a previous one
+    void                                    enableUrlCache(UrlCache::Options options = {});
+    void                                    disableUrlCache();
+    [[nodiscard]] std::shared_ptr<UrlCache> urlCache() const;
+
+    /**
+     * @brief streams `source` (empty: browser picker, otherwise a local path) in chunks of `chunkSize` bytes instead of loading
+     * it as a whole. Memory stays bounded by a few chunk buffers (see StreamState) independent of the file size.
+     */
+    [[nodiscard]] FileStream     loadFileStream(std::string_view source = {}, std::size_t chunkSize = kDefaultChunkSize, std::string_view acceptedFileExtensions = "", bool acceptMultipleFiles = false);
+    std::shared_ptr<StreamState> findStream(std::size_t streamID); // used by the JS glue
+
+    /**
+     * @brief returns the delivered files of `requestID` (O(its own files), other requests' data is never touched) or of all requests in
+     * delivery order if no ID is given. A mailbox concurrently drained by another thread is skipped (its files go to that caller).
+     * N.B. requests consumed via then() or co_await (incl. the loads of a loadBatch()) are not delivered here, their files are
+     * only held by the Request itself.
+     */
+    [[nodiscard]] std::vector<FileData> pollUploadedFile(std::optional<std::size_t> requestID = std::nullopt) noexcept;
+
+    /**
+     * @brief writes `data` to the native file `path` or, on WASM, offers it as a download. The payload is not copied where possible:
+     * a ByteBuffer is shared (fan-out of one payload to many files keeps a single copy alive) and an rvalue
+     * `std::vector<std::uint8_t>` is adopted, other ranges are copied once. Cached loads of `path` are invalidated on enqueue.
+     * - native: handed to the WriteBehind engine from any thread (incl. the render thread, which thus never waits for the disk),
+     *   Sync mode blocks until this and all previously enqueued writes are on disk
+     * - WASM: called off the main thread in Async mode, the write is queued for processPendingWrites()
+     */
     template<ExecutionMode mode = ExecutionMode::Async, std::ranges::contiguous_range Data = std::vector<std::uint8_t>>
     void writeFile(std::string_view path, Data&& data);
-    void processPendingWrites();
+
+    static constexpr auto kUnlimitedWriteBudget = std::chrono::microseconds::max();
+
+    /**
+     * @brief performs writes queued by workers (WASM: Blob downloads) on the main thread, called once per frame by the render loop.
+     * Stops once `budget` is spent (checked after each write, at least one write per call) and leaves the rest for later frames,
+     * i.e. a burst of background exports is spread over several frames. Returns the number of writes performed.
+     * N.B. producers block (see kWriteQueueTimeout) while the queue is full: the budget should fit at least a few writes per frame.
+     */
+    std::size_t                        processPendingWrites(std::chrono::microseconds budget = kUnlimitedWriteBudget);
+    [[nodiscard]] WriteDrainStatistics writeDrainStatistics() const noexcept { return _drainStatistics; } // main thread
+
+    /// native writeFile() engine: durability policy and batching (see WriteBehind), flushWrites() blocks until all are written
+    void                                  setWriteBehindOptions(WriteBehind::Options options);
+    void                                  flushWrites();
+    [[nodiscard]] WriteBehind::Statistics writeStatistics();
+
+    /// peak backlog of a single request's mailbox (segment granularity) -> guide for sizing the mailbox segment size
+    [[nodiscard]] std::size_t uploadQueueHighWaterMark() const noexcept { return _mailboxHighWaterMark.load(std::memory_order_relaxed); }
 
     void setHttpLoadCallback(HttpLoadCallback cb) { _httpLoader = std::move(cb); }
     void setFileDialogCallback(FileDialogCallback cb) { _fileDialog = std::move(cb); }
@@ -222,8 +695,19 @@ public:
 
 template<ExecutionMode mode, std::ranges::contiguous_range Data>
 void FileIo::writeFile(std::string_view path, Data&& data) {
+    invalidateAsset(path); // later loadFile()s must not be served the previous content from the asset cache
+#ifndef __EMSCRIPTEN__
+    WriteBehind& engine = writeBehind();
+    engine.enqueue(std::string(path), toByteBuffer(std::forward<Data>(data)));
+    if constexpr (mode == ExecutionMode::Sync) {
+        engine.flush();
+    }
+#else
     if (!isMainThread() && mode == ExecutionMode::Async) {
-        _pendingWrites.push_back(FileData{.requestID = 0UZ, .name = std::string(path), .data = data});
+        // back-pressure: block the worker (instead of dropping the write) while the main thread drains a full queue
+        if (!_pendingWrites.push_back_wait(FileData{.requestID = 0UZ, .name = std::string(path), .data = toByteBuffer(std::forward<Data>(data))}, kWriteQueueTimeout)) {
+            std::println(stderr, "[FileIo] pending-write queue full for {} - dropped write of '{}'", kWriteQueueTimeout, path);
+        }
         return;
     }
     if constexpr (mode == ExecutionMode::Sync) {
@@ -231,7 +715,6 @@ void FileIo::writeFile(std::string_view path, Data&& data) {
         processPendingWrites();
     }
 
-#ifdef __EMSCRIPTEN__
     EM_ASM(
         {
             const filename = UTF8ToString($0);
@@ -272,24 +755,18 @@ void FileIo::writeFile(std::string_view path, Data&& data) {
             }
         },
         path.data(), data.data(), static_cast<int>(data.size()));
-#else
-    try {
-        std::ofstream out(std::string(path), std::ios::binary);
-        if (!out) {
-            throw std::runtime_error(std::format("Failed to open file for writing: '{}'", path));
-        }
-        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
-        std::println("[FileIo] File written: {} ({} bytes)", path, data.size());
-    } catch (const std::exception& e) {
-        std::println("[FileIo] Error writing file: {}", e.what());
-    }
 #endif
 }
 
 } // namespace file
 
 #ifdef __EMSCRIPTEN__
-extern "C" void handle_uploaded_files(std::size_t requestID, const uint8_t* buffer, int length);
+extern "C" void handle_uploaded_files(std::size_t requestID, uint8_t* buffer, int length); // takes ownership of the malloc'ed 'buffer'
+extern "C" int  handle_stream_room(std::size_t streamID);
+extern "C" void handle_stream_begin(std::size_t streamID, double totalBytes);
+extern "C" void handle_stream_chunk(std::size_t streamID, int fileIndex, const char* name, double offset, double fileSize, uint8_t* data, int length, int last); // takes ownership of 'data'
+extern "C" void handle_stream_end(std::size_t streamID, const char* error);
+extern "C" void handle_url_cache_loaded();
 #endif
 
 #endif // FILE_IO_HPP
\ No newline at end of file
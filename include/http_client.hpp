@@ -0,0 +1,114 @@
+#ifndef HTTP_CLIENT_HPP
+#define HTTP_CLIENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+using Headers = std::vector<std::pair<std::string, std::string>>;
+
+struct Url {
+    std::string   host;
+    std::uint16_t port = 80U;
+    std::string   target = "/"; // path + query
+
+    /// parses 'http://host[:port][/path][?query]', https and other schemes are rejected (no TLS support)
+    static std::expected<Url, std::string> parse(std::string_view url);
+
+    std::string authority() const { // 'Host' header value
+        const std::string name = host.contains(':') ? std::format("[{}]", host) : host; // IPv6 literal
+        return port == 80U ? name : std::format("{}:{}", name, port);
+    }
+};
+
+struct Response {
+    int                       status = 0;
+    Headers                   headers; // names lower-cased
+    std::vector<std::uint8_t> body;
+
+    [[nodiscard]] std::string_view header(std::string_view lowerCaseName) const noexcept;
+};
+
+/**
+ * @brief minimal blocking HTTP/1.1 client (GET only, plain http) for native builds
+ *
+ * Connections are kept alive and reused: each `host:port` has a small pool of idle sockets and at most
+ * `Options::maxConnectionsPerHost` sockets in use at any time, further requests to the same host wait for a free connection.
+ * A reused connection that the server closed in the meantime is detected on the first read and the request is retried once
+ * on a fresh connection. Supports Content-Length, chunked and close-delimited bodies and follows redirects.
+ * Thread-safe: concurrent `get()` calls share the pool. On Emscripten builds, use emscripten_fetch instead (get() returns an error).
+ *
+ * @code
+ * http::Client client;
+ * if (auto response = client.get("http://localhost:8080/assets/data.bin"); response && response->status == 200) { ... }
+ * @endcode
+ */
+class Client {
+public:
+    struct Options {
+        std::size_t               maxConnectionsPerHost = 4UZ;
+        std::chrono::milliseconds timeout{30'000};     // connect and per-read/-write timeout
+        std::chrono::milliseconds idleTimeout{15'000}; // pooled connections unused for longer are closed instead of reused
+        std::size_t               maxRedirects = 5UZ;
+    };
+
+    static constexpr std::chrono::milliseconds kCancelPollInterval{50};
+
+    struct Statistics {
+        std::size_t connectionsOpened; // new TCP connections
+        std::size_t connectionsReused; // requests served over a pooled keep-alive connection
+    };
+
+    Client() : Client(Options{}) {}
+    explicit Client(Options options) : _options(options) {}
+    Client(const Client&)            = delete;
+    Client& operator=(const Client&) = delete;
+    ~Client() noexcept;
+
+    /**
+     * @brief `requestHeaders` are sent in addition to Host/User-Agent/Accept/Connection, e.g. validators for conditional requests.
+     * Setting `*cancelled` aborts the transfer (checked every kCancelPollInterval while waiting for data, the connection is
+     * closed) and get() returns an error.
+     */
+    [[nodiscard]] std::expected<Response, std::string> get(std::string_view url, const Headers& requestHeaders = {}, const std::atomic<bool>* cancelled = nullptr);
+    [[nodiscard]] Statistics                           statistics() const noexcept;
+
+private:
+    struct IdleConnection {
+        int                                   fd;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    struct HostPool {
+        std::vector<IdleConnection> idle;
+        std::size_t                 inUse = 0UZ;
+    };
+
+    Options                                   _options;
+    mutable std::mutex                        _poolMutex;
+    std::condition_variable                   _connectionReleased;
+    std::unordered_map<std::string, HostPool> _pools; // key: "host:port"
+    std::size_t                               _connectionsOpened = 0UZ;
+    std::size_t                               _connectionsReused = 0UZ;
+
+    std::expected<Response, std::string> request(const Url& url, const Headers& requestHeaders, const std::atomic<bool>* cancelled);
+    std::expected<int, std::string>      acquire(const Url& url, bool& reused); // blocks while the host's connections are all in use
+    void                                 release(const Url& url, int fd, bool keepAlive);
+    std::expected<int, std::string>      connectTo(const Url& url) const;
+};
+
+} // namespace http
+
+#endif // HTTP_CLIENT_HPP
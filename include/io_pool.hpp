@@ -0,0 +1,125 @@
+#ifndef IO_POOL_HPP
+#define IO_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ByteBuffer.hpp>
+
+namespace file {
+
+/**
+ * @brief how loadFile() reads local (native or WASM virtual file system) paths
+ *
+ * - Auto: Map for files of at least kMapThreshold bytes where supported, Read otherwise; the mapping is prefaulted by the loading
+ *   thread, i.e. the data is resident once the load completes
+ * - Map: read-only memory mapping, pages are loaded lazily on first access and shared with the OS page cache (POSIX native only,
+ *   falls back to Read elsewhere)
+ * - Read: one sized read into a private buffer
+ */
+enum class LoadMode : std::uint8_t { Auto = 0, Map, Read };
+
+inline constexpr std::size_t kMapThreshold = 1UZ << 20; // LoadMode::Auto maps files from 1 MiB on
+
+using ReadResult = std::expected<ByteBuffer, std::string>;
+
+/// byte window of a partial load: `length` bytes from `offset`, clamped to the source size (default: the whole source)
+struct ByteRange {
+    static constexpr std::uint64_t kToEnd = std::numeric_limits<std::uint64_t>::max();
+
+    std::uint64_t offset = 0U;
+    std::uint64_t length = kToEnd;
+
+    [[nodiscard]] constexpr bool whole() const noexcept { return offset == 0U && length == kToEnd; }
+
+    /// {offset, count} of the window within a source of `size` bytes (count 0 if it starts past the end)
+    [[nodiscard]] constexpr std::pair<std::size_t, std::size_t> clampTo(std::uint64_t size) const noexcept {
+        const std::uint64_t begin = std::min(offset, size);
+        return {static_cast<std::size_t>(begin), static_cast<std::size_t>(std::min(length, size - begin))};
+    }
+};
+
+/// abandon flag of a load (see Request::cancel()), polled by the loaders before they allocate or issue further I/O, may be null
+using CancelFlag = std::shared_ptr<const std::atomic<bool>>;
+
+[[nodiscard]] inline bool isCancelled(const CancelFlag& flag) noexcept { return flag && flag->load(std::memory_order_acquire); }
+
+[[nodiscard]] ReadResult readFile(const std::string& path);
+[[nodiscard]] ReadResult mapFile(const std::string& path, std::size_t minSize = kMapThreshold, bool prefault = false); // prefault: read all pages before returning
+[[nodiscard]] ReadResult readFileRange(const std::string& path, ByteRange range); // positioned read of the window only
+[[nodiscard]] ReadResult loadLocalFile(const std::string& path, LoadMode mode, ByteRange range = {}); // blocking, dispatches on 'mode'
+
+/**
+ * @brief asynchronous whole-file loads for FileIo::loadFile(): `submit()` returns immediately, the completion runs on an I/O thread
+ *
+ * Backends:
+ * - io_uring (Linux, if built with liburing, i.e. `HAVE_LIBURING`, and the kernel allows it): one thread splits LoadMode::Read
+ *   files into `kBlockSize` reads and keeps up to `queueDepth()` of them in flight across all submitted files, enough to
+ *   saturate NVMe drives from a single thread.
+ * - thread pool (fallback): up to `queueDepth()` workers each perform one blocking load at a time.
+ * LoadMode::Map only maps the file, which is cheap, the actual I/O happens lazily on page faults (of the consumer). Auto maps
+ * large files too but faults their pages in on the I/O thread before completing (the io_uring backend reads them through the ring
+ * instead), so the consumer, e.g. the render thread, never stalls on disk reads.
+ * A load whose `cancelled` flag is set completes with an error without being read, or, with io_uring, after its in-flight
+ * blocks instead of the whole file. A `range` restricts the load to that window (mapped: only its pages are touched).
+ * The destructor completes all submitted loads before returning.
+ */
+class IoPool {
+public:
+    using Completion = std::function<void(ReadResult&&)>;
+
+    static constexpr std::size_t kDefaultQueueDepth = 16UZ;
+    static constexpr std::size_t kMaxQueueDepth     = 256UZ;
+    static constexpr std::size_t kBlockSize         = 1UZ << 20; // io_uring read granularity
+
+    explicit IoPool(std::size_t queueDepth = kDefaultQueueDepth);
+    IoPool(const IoPool&)            = delete;
+    IoPool& operator=(const IoPool&) = delete;
+    ~IoPool() noexcept;
+
+    void submit(std::string path, LoadMode mode, Completion onDone, CancelFlag cancelled = {}, ByteRange range = {});
+
+    /// maximum number of loads (thread pool) or block reads (io_uring) in flight, clamped to [1, kMaxQueueDepth]
+    void                      setQueueDepth(std::size_t depth);
+    [[nodiscard]] std::size_t queueDepth() const noexcept { return _queueDepth.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool        usesIoUring() const noexcept { return _ring != nullptr; }
+
+private:
+    struct Job {
+        std::string path;
+        LoadMode    mode;
+        Completion  onDone;
+        CancelFlag  cancelled;
+        ByteRange   range;
+    };
+    struct Ring; // io_uring state, only defined with HAVE_LIBURING
+
+    std::atomic<std::size_t> _queueDepth;
+    std::mutex               _mutex;
+    std::condition_variable  _jobAvailable;
+    std::deque<Job>          _jobs;
+    std::size_t              _active   = 0UZ; // thread pool: loads in progress
+    bool                     _stopping = false;
+    std::vector<std::thread> _workers;
+    std::unique_ptr<Ring>    _ring;
+
+    void runWorker();
+    void runRing();
+};
+
+} // namespace file
+
+#endif // IO_POOL_HPP
@@ -0,0 +1,106 @@
+#ifndef URL_CACHE_HPP
+#define URL_CACHE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <ByteBuffer.hpp>
+#include <http_client.hpp>
+
+namespace file {
+
+/**
+ * @brief persistent, size-bounded cache for URL loads through FileIo's default HTTP loader (see FileIo::enableUrlCache())
+ *
+ * Each entry is stored as a body file plus a small metadata file (URL, ETag, Last-Modified, time stored, lifetime) named by a hash of the
+ * URL inside `Options::directory`:
+ * - native: defaults to `$XDG_CACHE_HOME/wasm-threading/url` (or `~/.cache/...`), bodies are memory-mapped on lookup
+ * - WASM: the directory is an IDBFS mount (IndexedDB), restored asynchronously at start-up (lookups miss until then) and written
+ *   back shortly after each change. N.B. cross-origin responses expose ETag/Last-Modified only via Access-Control-Expose-Headers.
+ *
+ * Entries are served without network access for the lifetime granted by their response (see lifetimeOf(): `Cache-Control: max-age`,
+ * otherwise `Expires`, otherwise `Options::freshFor`). Older ones, and those marked `no-cache` or `max-age=0`, are revalidated with a
+ * conditional request (If-None-Match/If-Modified-Since) and a `304 Not Modified` refreshes the entry instead of transferring the
+ * body again. Responses marked `no-store` or `private` are not stored. Least-recently used entries are evicted once the cached
+ * bodies exceed `Options::maxBytes`. Thread-safe.
+ */
+class UrlCache {
+public:
+    struct Options {
+        std::filesystem::path directory; // empty: platform default (see above)
+        std::uint64_t         maxBytes = 256ULL << 20;
+        std::chrono::seconds  freshFor{3600}; // lifetime of responses without max-age/Expires
+    };
+
+    struct Entry {
+        ByteBuffer  data;
+        std::string etag;
+        std::string lastModified;
+        bool        fresh; // within its lifetime: usable without revalidation
+    };
+
+    struct Statistics {
+        std::size_t   hits;        // fresh entries served without network access
+        std::size_t   revalidated; // stale entries confirmed by a 304
+        std::size_t   misses;      // lookups without a (readable) entry
+        std::size_t   stores;      // bodies written, incl. replacements of stale entries
+        std::size_t   evictions;
+        std::size_t   entries;
+        std::uint64_t bytes; // cached body bytes
+    };
+
+    UrlCache() : UrlCache(Options{}) {}
+    explicit UrlCache(Options options);
+    UrlCache(const UrlCache&)            = delete;
+    UrlCache& operator=(const UrlCache&) = delete;
+
+    [[nodiscard]] std::optional<Entry> lookup(std::string_view url);
+    void                               store(std::string_view url, const ByteBuffer& data, std::string_view etag, std::string_view lastModified, std::optional<std::chrono::seconds> lifetime = std::nullopt); // lifetime: see lifetimeOf(), std::nullopt: Options::freshFor
+    void                               refresh(std::string_view url, std::optional<std::chrono::seconds> lifetime = std::nullopt); // after a 304: restarts the entry's freshness period
+    void                               clear();
+    void                               reload(); // re-reads the index from disk (WASM: after IndexedDB has been restored)
+
+    [[nodiscard]] static http::Headers conditionalHeaders(const Entry& entry); // If-None-Match/If-Modified-Since for a stale entry
+    [[nodiscard]] static bool          cacheable(std::string_view cacheControl) noexcept; // false for 'no-store' and 'private'
+
+    /// lifetime granted by the response headers: `no-cache` -> 0, `max-age=N` -> N, otherwise `Expires` (an invalid or past date -> 0),
+    /// std::nullopt if the response has none of them
+    [[nodiscard]] static std::optional<std::chrono::seconds> lifetimeOf(std::string_view cacheControl, std::string_view expires);
+
+    [[nodiscard]] Statistics                   statistics() const;
+    [[nodiscard]] const std::filesystem::path& directory() const noexcept { return _options.directory; }
+
+private:
+    struct Record {
+        std::string   etag;
+        std::string   lastModified;
+        std::int64_t  storedAt; // seconds since epoch
+        std::int64_t  lifetime; // seconds after 'storedAt' the entry is fresh
+        std::uint64_t size;
+        std::uint64_t lastUsed; // LRU clock
+    };
+
+    Options                                 _options;
+    mutable std::mutex                      _mutex;
+    std::unordered_map<std::string, Record> _index; // key: URL
+    std::uint64_t                           _bytes = 0U;
+    std::uint64_t                           _clock = 0U;
+    Statistics                              _statistics{};
+
+    [[nodiscard]] std::filesystem::path pathOf(std::string_view url, std::string_view extension) const;
+    bool                                writeMeta(std::string_view url, const Record& record) const;
+    void                                erase(const std::string& url);
+    void                                evict();
+    void                                persist() const;
+};
+
+} // namespace file
+
+#endif // URL_CACHE_HPP
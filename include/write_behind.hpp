@@ -0,0 +1,101 @@
+#ifndef WRITE_BEHIND_HPP
+#define WRITE_BEHIND_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ByteBuffer.hpp>
+
+namespace file {
+
+/**
+ * @brief when files written by WriteBehind are forced to stable storage
+ *
+ * - None: no fsync, a power failure may lose recent files (but never leaves a torn one, see WriteBehind)
+ * - Batched: the files of a batch are synced together before they are renamed (group commit), each directory once per batch
+ * - EveryWrite: each file is synced and renamed (and its directory synced) before the next one is written
+ */
+enum class Durability : std::uint8_t { None = 0, Batched, EveryWrite };
+
+/**
+ * @brief write-behind engine for native FileIo::writeFile(): callers only enqueue, a dedicated I/O thread touches the disk
+ *
+ * Writes enqueued while the thread is busy form the next batch (up to `Options::maxBatchBytes` and `Options::maxBatchFiles`). Within a batch, repeated writes
+ * of the same path are coalesced (only the last one reaches the disk). Each file is written with positional writes straight from
+ * the shared ByteBuffer into `<path>.tmp`, which is then renamed over `path`: readers observe either the old or the new content.
+ * On Linux, write-back of a batch's files is started while the next ones are still being written, so a Batched sync mostly waits
+ * for I/O that is already in flight.
+ *
+ * `flush()` blocks until everything enqueued before has been written (and synced, depending on the Durability), the destructor
+ * drains the queue. Errors are logged and counted in the statistics. Thread-safe.
+ */
+class WriteBehind {
+public:
+    struct Options {
+        Durability  durability    = Durability::Batched;
+        std::size_t maxBatchBytes = 64UZ << 20; // payload bytes per batch (a larger single write forms a batch of its own)
+        std::size_t maxBatchFiles = 256UZ;      // writes per batch: Batched keeps one descriptor per file open until the group sync (also capped to a quarter of RLIMIT_NOFILE)
+    };
+
+    struct Statistics {
+        std::size_t              writes;    // files written
+        std::size_t              failed;    // files that could not be written (the previous content is left untouched) or whose directory sync failed (renamed, not durable)
+        std::size_t              coalesced; // writes superseded by a later write of the same path before reaching the disk
+        std::size_t              batches;
+        std::size_t              syncs;   // fdatasync/fsync calls
+        std::size_t              pending; // enqueued, not yet written
+        std::uint64_t            bytes;
+        std::chrono::nanoseconds lastLatency; // enqueue() -> renamed (and synced)
+        std::chrono::nanoseconds meanLatency;
+        std::chrono::nanoseconds maxLatency;
+        double                   bytesPerSecond; // while writing, i.e. disk throughput excluding idle time
+    };
+
+    WriteBehind() : WriteBehind(Options{}) {}
+    explicit WriteBehind(Options options);
+    WriteBehind(const WriteBehind&)            = delete;
+    WriteBehind& operator=(const WriteBehind&) = delete;
+    ~WriteBehind() noexcept; // writes everything still queued
+
+    void enqueue(std::string path, ByteBuffer data); // never blocks on I/O
+    void flush();
+    void setOptions(Options options); // applies from the next batch on
+
+    [[nodiscard]] Statistics statistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Write {
+        std::string       path;
+        ByteBuffer        data;
+        Clock::time_point enqueued;
+    };
+
+    Options                 _options;
+    mutable std::mutex      _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _batchWritten; // wakes flush()
+    std::deque<Write>       _queue;
+    std::uint64_t           _enqueued = 0U; // number of writes enqueued so far
+    std::uint64_t           _done     = 0U; // number of writes taken from the queue and finished (written, coalesced or failed)
+    bool                    _stopping = false;
+    Statistics              _statistics{};
+    Clock::duration         _totalLatency{};
+    Clock::duration         _busy{};
+    std::thread             _worker; // N.B. declared last: started once the rest is initialised
+
+    void run();
+    void writeBatch(std::vector<Write>& batch, Durability durability);
+};
+
+} // namespace file
+
+#endif // WRITE_BEHIND_HPP
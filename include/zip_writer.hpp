@@ -0,0 +1,93 @@
+#ifndef ZIP_WRITER_HPP
+#define ZIP_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace file {
+
+/**
+ * @brief streaming ZIP archive writer: bundles many outputs into one native file or one browser download
+ *
+ * Entries are compressed (Deflate, if built with zlib, i.e. `HAVE_ZLIB`, Store otherwise) and appended to an output buffer of
+ * `chunkSize` bytes that is handed to the sink whenever it fills up, the central directory is written by `finish()`. Memory is
+ * thus bounded by the chunk size plus ~50 bytes of directory metadata per entry, independent of the total archive size.
+ * - native: the sink appends to the file `path`
+ * - WASM: the sink moves each chunk into a JS Blob part (browsers page large Blobs out of the JS heap), `finish()` triggers a
+ *   single download named `path` - instead of one Blob, object URL and click per file as with FileIo::writeFile()
+ *
+ * `add()` may be called from any thread (calls are serialised), the WASM sink proxies synchronously to the main thread, i.e. feed
+ * one writer either from the main thread or from workers but not from both at the same time. Limits: no ZIP64, i.e. at most
+ * 65535 entries and 4 GiB per entry and archive.
+ *
+ * @code
+ * file::ZipWriter zip("results.zip");
+ * for (const auto& [name, data] : results) {
+ *     if (auto ok = zip.add(name, data); !ok) { std::println(stderr, "{}", ok.error()); }
+ * }
+ * zip.finish(); // or implicitly by the destructor
+ * @endcode
+ */
+class ZipWriter {
+public:
+    enum class Method : std::uint16_t { Store = 0U, Deflate = 8U }; // values as in the ZIP format
+    using Sink   = std::function<bool(std::span<const std::uint8_t>)>; // returns false on write errors
+    using Status = std::expected<void, std::string>;
+
+    static constexpr std::size_t kDefaultChunkSize = 1UZ << 20;
+
+    /// writes to the native file `path` or, on WASM, downloads the archive as `path` once finished
+    explicit ZipWriter(std::string_view path, Method method = Method::Deflate, std::size_t chunkSize = kDefaultChunkSize);
+    /// writes to a custom sink, `onFinish(ok)` (optional) is called once after the last chunk
+    ZipWriter(Sink sink, std::function<void(bool ok)> onFinish, Method method = Method::Deflate, std::size_t chunkSize = kDefaultChunkSize);
+    ZipWriter(const ZipWriter&)            = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+    ~ZipWriter() noexcept; // finishes the archive if not done explicitly, errors are logged
+
+    Status add(std::string_view name, std::span<const std::uint8_t> data);
+    Status finish(); // writes the central directory and flushes, further add() calls fail
+
+    [[nodiscard]] std::size_t   entries() const;
+    [[nodiscard]] std::uint64_t bytesWritten() const; // archive bytes handed to the sink so far
+    [[nodiscard]] static bool   hasDeflate() noexcept; // false: built without zlib -> Method::Deflate stores
+
+private:
+    struct Entry {
+        std::string   name;
+        std::uint32_t crc;
+        std::uint32_t compressedSize;
+        std::uint32_t size;
+        std::uint32_t offset; // of the local file header
+        std::uint16_t method;
+        std::uint16_t flags;
+    };
+
+    mutable std::mutex        _mutex;
+    Sink                      _sink;
+    std::function<void(bool)> _onFinish;
+    Method                    _method;
+    std::size_t               _chunkSize;
+    std::vector<std::uint8_t> _buffer; // pending output, flushed at '_chunkSize'
+    std::vector<Entry>        _entries;
+    std::uint64_t             _offset  = 0U; // archive bytes emitted (sink + buffer)
+    std::uint64_t             _flushed = 0U; // archive bytes handed to the sink
+    std::uint16_t             _dosTime = 0U;
+    std::uint16_t             _dosDate = 0U;
+    std::string               _error; // sticky: first sink/compression failure
+    bool                      _finished = false;
+
+    void   put(std::span<const std::uint8_t> bytes); // buffered, large payloads are passed on in chunk-sized slices
+    bool   flush();
+    Status putDeflated(std::span<const std::uint8_t> data, std::uint32_t& compressedSize);
+};
+
+} // namespace file
+
+#endif // ZIP_WRITER_HPP
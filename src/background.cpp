@@ -19,6 +19,7 @@ void BackgroundProcessor::start() {
 
 void BackgroundProcessor::stop() {
     _running = false;
+    _wakeUp.notify_all();
     if (_thread.joinable()) {
         _thread.join();
     }
@@ -33,7 +34,7 @@ void BackgroundProcessor::process() {
         std::string fileName = std::format("test_file_{}.txt", i);
         std::println("writing to file: {}", fileName);
         file::FileIo::instance().writeFile(fileName, {'H', 'e', 'l', 'l', 'o'});
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        _wakeUp.wait_until([this] { return !_running.load(); }, atomic_wait::deadlineAfter(std::chrono::milliseconds(100)));
 
     }
 }
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <format>
+#include <memory>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <decompress.hpp>
+
+namespace file {
+
+namespace {
+constexpr std::array<std::uint8_t, 3UZ> kGzipMagic{0x1fU, 0x8bU, 0x08U}; // ID1, ID2, CM = deflate (the only method defined)
+constexpr std::array<std::uint8_t, 4UZ> kZstdMagic{0x28U, 0xb5U, 0x2fU, 0xfdU};
+constexpr std::uint64_t                 kMaxDeflateRatio = 1032U;    // upper bound of deflate's compression ratio
+constexpr std::uint64_t                 kMaxSizeHint     = 1ULL << 30; // size fields are untrusted input: larger outputs grow on demand
+
+constexpr std::array<std::string_view, 4UZ> kSuffixes{".gz", ".gzip", ".zst", ".zstd"};
+
+bool startsWith(std::span<const std::uint8_t> data, std::span<const std::uint8_t> magic) noexcept { return data.size() >= magic.size() && std::ranges::equal(data.first(magic.size()), magic); }
+
+// member header incl. a valid FLG byte (reserved bits 5-7 zero) and room for an empty deflate block plus trailer, i.e. binary data
+// that merely starts with '1f 8b' is not mistaken for gzip
+bool isGzipMember(std::span<const std::uint8_t> data) noexcept { return data.size() >= 18UZ && startsWith(data, kGzipMagic) && (data[3UZ] & 0xe0U) == 0U; }
+
+// zstd skippable frames (0x184D2A50..5F, little-endian) may precede the first data frame
+bool isSkippableFrame(std::span<const std::uint8_t> data) noexcept { return data.size() >= 4UZ && (data[0UZ] & 0xf0U) == 0x50U && data[1UZ] == 0x2aU && data[2UZ] == 0x4dU && data[3UZ] == 0x18U; }
+
+// decoder output written in place: allocated once (uninitialised) from the size hint, grown geometrically only if the hint was short
+class Output {
+    std::unique_ptr<std::uint8_t[]> _data;
+    std::size_t                     _capacity;
+    std::size_t                     _size = 0UZ;
+
+public:
+    explicit Output(std::size_t capacity) : _data(std::make_unique_for_overwrite<std::uint8_t[]>(capacity)), _capacity(capacity) {}
+
+    /// free space behind the written bytes, at least `minimum` bytes
+    std::span<std::uint8_t> room(std::size_t minimum) {
+        if (_capacity - _size < minimum) {
+            resize(std::max(_capacity * 2UZ, _size + minimum));
+        }
+        return {_data.get() + _size, _capacity - _size};
+    }
+    void commit(std::size_t n) noexcept { _size += n; }
+
+    ByteBuffer release() && {
+        if (_size < _capacity / 2UZ) { // hint far too large (corrupt size field): don't keep the slack alive
+            resize(_size);
+        }
+        std::shared_ptr<const std::uint8_t[]> owner(std::move(_data));
+        return ByteBuffer(owner, std::span(owner.get(), _size));
+    }
+
+private:
+    void resize(std::size_t capacity) {
+        auto data = std::make_unique_for_overwrite<std::uint8_t[]>(capacity);
+        std::memcpy(data.get(), _data.get(), _size);
+        _data     = std::move(data);
+        _capacity = capacity;
+    }
+};
+
+#ifdef HAVE_ZLIB
+// ISIZE of the last member (output size modulo 2^32), bounded by what deflate could have produced from 'input'
+std::size_t gzipSizeHint(std::span<const std::uint8_t> input) noexcept {
+    if (input.size() < 18UZ) { // header + empty deflate block + trailer
+        return 0UZ;
+    }
+    const auto          trailer = input.last(4UZ);
+    const std::uint64_t size    = trailer[0UZ] | (trailer[1UZ] << 8U) | (trailer[2UZ] << 16U) | (static_cast<std::uint64_t>(trailer[3UZ]) << 24U);
+    return static_cast<std::size_t>(std::min({size, input.size() * kMaxDeflateRatio, kMaxSizeHint}));
+}
+
+std::expected<ByteBuffer, std::string> inflateGzip(std::span<const std::uint8_t> input, std::size_t chunkSize) {
+    z_stream stream{};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) { // +16: gzip wrapper
+        return std::unexpected("inflateInit2 failed");
+    }
+    Output      output(gzipSizeHint(input));
+    std::string error;
+    std::size_t consumed = 0UZ;
+    bool        full     = false; // the last call filled the output: more room before the next one
+    while (error.empty()) {
+        if (stream.avail_in == 0U && consumed < input.size()) {
+            const std::size_t n = std::min<std::size_t>({input.size() - consumed, chunkSize, UINT_MAX});
+            stream.next_in      = const_cast<Bytef*>(input.data() + consumed);
+            stream.avail_in     = static_cast<uInt>(n);
+            consumed += n;
+        }
+        // inflate straight into the free space of the output (an exact hint leaves none for the trailer: zlib needs none)
+        const auto room  = output.room(full ? chunkSize : 0UZ);
+        stream.next_out  = room.data();
+        stream.avail_out = static_cast<uInt>(std::min<std::size_t>(room.size(), UINT_MAX));
+        const uInt given = stream.avail_out;
+        const int  rc    = ::inflate(&stream, Z_NO_FLUSH);
+        output.commit(given - stream.avail_out);
+        full = stream.avail_out == 0U;
+
+        if (rc == Z_STREAM_END) {
+            const auto rest = input.subspan(consumed - stream.avail_in);
+            if (!isGzipMember(rest)) {
+                break; // done, trailing padding (if any) is ignored like gzip does
+            }
+            inflateReset(&stream); // concatenated member
+        } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            error = stream.msg != nullptr ? stream.msg : std::format("inflate error {}", rc);
+        } else if (stream.avail_in == 0U && consumed == input.size() && stream.avail_out != 0U) {
+            error = "truncated gzip stream";
+        }
+    }
+    inflateEnd(&stream);
+    if (!error.empty()) {
+        return std::unexpected(std::move(error));
+    }
+    return std::move(output).release();
+}
+#endif
+
+#ifdef HAVE_ZSTD
+std::expected<ByteBuffer, std::string> decompressZstd(std::span<const std::uint8_t> input, std::size_t chunkSize) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if (context == nullptr) {
+        return std::unexpected("ZSTD_createDCtx failed");
+    }
+    std::uint64_t hint = 0U; // content size of the first frame
+    if (const unsigned long long size = ZSTD_getFrameContentSize(input.data(), input.size()); size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR) {
+        hint = std::min<std::uint64_t>(size, kMaxSizeHint);
+    }
+    Output        output(static_cast<std::size_t>(hint));
+    std::string   error;
+    std::size_t   consumed = 0UZ;
+    bool          full     = false; // the last call filled the output: more room before the next one
+    ZSTD_inBuffer in{input.data(), 0UZ, 0UZ};
+    while (error.empty()) {
+        if (in.pos == in.size && consumed < input.size()) {
+            const std::size_t n = std::min(input.size() - consumed, chunkSize);
+            in                  = ZSTD_inBuffer{input.data() + consumed, n, 0UZ};
+            consumed += n;
+        }
+        const auto        room = output.room(full ? chunkSize : 0UZ);
+        ZSTD_outBuffer    out{room.data(), room.size(), 0UZ};
+        const std::size_t rc = ZSTD_decompressStream(context, &out, &in);
+        output.commit(out.pos);
+        full = out.pos == out.size;
+
+        const bool inputDone = in.pos == in.size && consumed == input.size();
+        if (ZSTD_isError(rc)) {
+            error = ZSTD_getErrorName(rc);
+        } else if (inputDone && rc == 0UZ) {
+            break; // last frame complete and flushed
+        } else if (inputDone && !full) {
+            error = "truncated zstd stream";
+        }
+    }
+    ZSTD_freeDCtx(context);
+    if (!error.empty()) {
+        return std::unexpected(std::move(error));
+    }
+    return std::move(output).release();
+}
+#endif
+} // namespace
+
+Compression detectCompression(std::span<const std::uint8_t> data) noexcept {
+    if (isGzipMember(data)) {
+        return Compression::Gzip;
+    }
+    if (startsWith(data, kZstdMagic) || isSkippableFrame(data)) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+std::string_view stripCompressionSuffix(std::string_view name) noexcept {
+    for (const std::string_view suffix : kSuffixes) {
+        if (name.size() > suffix.size() && name.ends_with(suffix)) {
+            return name.substr(0UZ, name.size() - suffix.size());
+        }
+    }
+    return name;
+}
+
+bool canDecompress(Compression compression) noexcept {
+    switch (compression) {
+    case Compression::None: return true;
+#ifdef HAVE_ZLIB
+    case Compression::Gzip: return true;
+#endif
+#ifdef HAVE_ZSTD
+    case Compression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+std::expected<ByteBuffer, std::string> decompress(std::span<const std::uint8_t> input, Compression compression, std::size_t chunkSize) {
+    chunkSize = std::max(chunkSize, 1UZ);
+    switch (compression) {
+    case Compression::None: return ByteBuffer::copyOf(input);
+    case Compression::Gzip:
+#ifdef HAVE_ZLIB
+        return inflateGzip(input, chunkSize);
+#else
+        return std::unexpected("gzip: built without zlib");
+#endif
+    case Compression::Zstd:
+#ifdef HAVE_ZSTD
+        return decompressZstd(input, chunkSize);
+#else
+        return std::unexpected("zstd: built without libzstd");
+#endif
+    }
+    return std::unexpected("unknown compression");
+}
+
+} // namespace file
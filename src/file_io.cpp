@@ -1,63 +1,194 @@
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <memory>
 #include <print>
+#include <string_view>
+#include <thread>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #include <emscripten/html5.h>
 #endif
 
+#include <decompress.hpp>
 #include <file_io.hpp>
 
 namespace file {
 
+namespace {
+constexpr bool startsWith(std::string_view source, std::string_view prefix) { return source.size() >= prefix.size() && std::ranges::equal(prefix, source.substr(0, prefix.size()), [](char a, char b) { return std::tolower(a) == std::tolower(b); }); }
+constexpr bool isUrl(std::string_view source) { return startsWith(source, "http://") || startsWith(source, "https://"); }
+
+// cache/coalescing key: URLs with lower-case scheme and host and without fragment, paths lexically normalised
+std::string normaliseSource(std::string_view source) {
+    if (!isUrl(source)) {
+        return std::filesystem::path(source).lexically_normal().generic_string();
+    }
+    std::string       key(source.substr(0UZ, source.find('#')));
+    const std::size_t hostEnd = std::min(key.find_first_of("/?", key.find("://") + 3UZ), key.size());
+    std::transform(key.begin(), key.begin() + static_cast<std::ptrdiff_t>(hostEnd), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return key;
+}
+
+// ranged loads are memoised separately per window: "<normalised source>\nbytes=<offset>+<length>"
+std::string rangeKey(std::string key, ByteRange range) { return range.whole() ? key : std::format("{}\nbytes={}+{}", key, range.offset, range.length); }
+
+ByteBuffer window(const ByteBuffer& data, ByteRange range) {
+    const auto [offset, count] = range.clampTo(data.size());
+    return data.slice(offset, count); // shares the storage
+}
+
+// HTTP Range request for 'range' (RFC 9110: inclusive last byte, open-ended for the rest of the resource)
+http::Headers rangeHeader(ByteRange range) {
+    const bool toEnd = range.length == ByteRange::kToEnd || range.length > ByteRange::kToEnd - range.offset;
+    return {{"Range", toEnd ? std::format("bytes={}-", range.offset) : std::format("bytes={}-{}", range.offset, range.offset + range.length - 1U)}};
+}
+
+// native (and WASM virtual file system) producer of loadFileStream(): sequential buffered reads, blocks while the consumer lags behind
+void readFileStream(const std::shared_ptr<StreamState>& state, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        state->finish(std::format("could not open '{}'", path));
+        return;
+    }
+    std::error_code     ec;
+    const std::uint64_t fileSize = std::filesystem::file_size(path, ec);
+    state->bytesTotal.store(ec ? 0U : fileSize, std::memory_order_relaxed);
+
+    for (std::uint64_t offset = 0U; !state->cancelled.load(std::memory_order_acquire);) {
+        std::vector<std::uint8_t> buffer(state->chunkSize);
+        in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        buffer.resize(static_cast<std::size_t>(in.gcount()));
+        if (in.bad()) {
+            state->finish(std::format("read error in '{}' at offset {}", path, offset));
+            return;
+        }
+        const std::size_t nBytes = buffer.size();
+        const bool        last   = in.eof() || in.peek() == std::ifstream::traits_type::eof();
+        if (!state->deliver(FileChunk{.requestID = state->streamID, .fileIndex = 0UZ, .name = path, .offset = offset, .fileSize = ec ? 0U : fileSize, .data = std::move(buffer), .last = last})) {
+            return; // cancelled
+        }
+        offset += nBytes;
+        if (last) {
+            break;
+        }
+    }
+    state->finish();
+}
+
+#ifdef __EMSCRIPTEN__
+// per-fetch state of triggerHttpLoad(), owned by the fetch's userData until onsuccess/onerror
+struct FetchContext {
+    std::size_t                    requestID;
+    CancelFlag                     cancelled;
+    std::shared_ptr<UrlCache>      cache;
+    std::optional<UrlCache::Entry> cached; // stale entry being revalidated
+    std::optional<ByteRange>       range;  // ranged load: neither revalidated nor stored
+    std::vector<std::string>       headerStrings;
+    std::vector<const char*>       headers; // null-terminated name/value list for emscripten_fetch
+};
+
+std::unordered_map<std::size_t, emscripten_fetch_t*> activeFetches; // key: requestID, main thread only
+
+// main thread only: closing a running fetch aborts the XHR and calls its onerror synchronously, which skips fetches whose
+// context was taken (userData == nullptr)
+void abortFetch(std::size_t requestID) {
+    auto it = activeFetches.find(requestID);
+    if (it == activeFetches.end()) {
+        return; // completed already or not started yet (the latter checks the cancel flag)
+    }
+    emscripten_fetch_t*           fetch = it->second;
+    std::unique_ptr<FetchContext> context(static_cast<FetchContext*>(fetch->userData));
+    activeFetches.erase(it);
+    fetch->userData = nullptr;
+    emscripten_fetch_close(fetch);
+}
+
+std::string responseHeader(emscripten_fetch_t* fetch, std::string_view lowerCaseName) {
+    std::string raw(emscripten_fetch_get_response_headers_length(fetch) + 1UZ, '\0');
+    emscripten_fetch_get_response_headers(fetch, raw.data(), raw.size());
+    for (std::string_view rest(raw.c_str()); !rest.empty();) { // 'name: value\r\n' lines
+        const std::size_t end  = std::min(rest.find('\n'), rest.size());
+        std::string_view  line = rest.substr(0UZ, end);
+        rest.remove_prefix(std::min(end + 1UZ, rest.size()));
+        if (startsWith(line, lowerCaseName) && line.size() > lowerCaseName.size() && line[lowerCaseName.size()] == ':') {
+            line.remove_prefix(lowerCaseName.size() + 1UZ);
+            const std::size_t first = line.find_first_not_of(" \t");
+            const std::size_t last  = line.find_last_not_of(" \t\r");
+            return first == std::string_view::npos ? std::string{} : std::string(line.substr(first, last - first + 1UZ));
+        }
+    }
+    return {};
+}
+#endif
+} // namespace
+
 std::vector<FileData> FileIo::triggerHttpLoad(std::size_t requestID, std::string_view url) {
 #ifdef __EMSCRIPTEN__
     if (emscripten_is_main_runtime_thread()) { // call from within the main thread
+        auto context = std::make_unique<FetchContext>(FetchContext{.requestID = requestID, .cancelled = cancelFlagOf(requestID), .cache = urlCache(), .range = takeRange(requestID)});
+        if (isCancelled(context->cancelled)) {
+            return {}; // abandoned before the (proxied) call got here
+        }
+        if (context->range && context->range->length == 0U) {
+            pushUploadedFiles({FileData{.requestID = requestID, .name = std::string(url), .data = {}}});
+            return {};
+        }
+        if (context->cache) {
+            context->cached = context->cache->lookup(url);
+            if (context->cached && context->cached->fresh) { // no network access at all
+                pushUploadedFiles({FileData{.requestID = requestID, .name = std::string(url), .data = context->range ? window(context->cached->data, *context->range) : std::move(context->cached->data)}});
+                return {};
+            }
+            if (context->range) {
+                context->cached.reset(); // a partial response cannot revalidate the whole entry
+            }
+        }
+
         emscripten_fetch_attr_t attr;
         emscripten_fetch_attr_init(&attr);
         std::strcpy(attr.requestMethod, "GET");
         attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
-        attr.userData   = new std::size_t(requestID);
+        if (context->range || context->cached) { // ranged or stale -> 'Range' or conditional request
+            for (auto& [name, value] : context->range ? rangeHeader(*context->range) : UrlCache::conditionalHeaders(*context->cached)) {
+                context->headerStrings.push_back(std::move(name));
+                context->headerStrings.push_back(std::move(value));
+            }
+            for (const std::string& header : context->headerStrings) {
+                context->headers.push_back(header.c_str());
+            }
+            context->headers.push_back(nullptr);
+            attr.requestHeaders = context->headers.data();
+        }
 
         std::println("triggerHttpLoad - main thread ID: {}", std::this_thread::get_id());
 
         attr.onsuccess = [](emscripten_fetch_t* fetch) {
-            auto ID = *static_cast<std::size_t*>(fetch->userData);
-            delete static_cast<std::size_t*>(fetch->userData);
+            std::unique_ptr<FetchContext> context(static_cast<FetchContext*>(fetch->userData));
+            activeFetches.erase(context->requestID);
 
             std::println("triggerHttpLoad - onsuccess thread ID: {}", std::this_thread::get_id());
 
+            if (isCancelled(context->cancelled)) { // cancelled while the abort was being proxied: drop it before copying
+                emscripten_fetch_close(fetch);
+                return;
+            }
             try {
-                std::string filename      = fetch->url;
-                auto        filenameBytes = std::vector<uint8_t>(filename.begin(), filename.end());
-
-                const uint32_t numFiles = 1;
-                const uint32_t nameLen  = static_cast<uint32_t>(filenameBytes.size());
-                const uint32_t dataLen  = static_cast<uint32_t>(fetch->numBytes);
-                const size_t   totalSize = 4 + (4 + 4 + nameLen + dataLen);
-
-                std::vector<uint8_t> buffer(totalSize);
-                uint8_t* ptr = buffer.data();
-
-                auto write_uint32 = [&ptr](uint32_t v) {
-                    std::memcpy(ptr, &v, sizeof(v));
-                    ptr += sizeof(v);
-                };
-                auto write_bytes = [&ptr](const uint8_t* data, size_t size) {
-                    std::memcpy(ptr, data, size);
-                    ptr += size;
-                };
-
-                write_uint32(numFiles);
-                write_uint32(nameLen);
-                write_uint32(dataLen);
-                write_bytes(filenameBytes.data(), nameLen);
-                write_bytes(reinterpret_cast<const uint8_t*>(fetch->data), dataLen);
-
-                handle_uploaded_files(ID, buffer.data(), static_cast<int>(buffer.size()));
+                // single copy out of the fetch-owned memory (released by emscripten_fetch_close) - no intermediate wire buffer
+                auto body = std::span(reinterpret_cast<const uint8_t*>(fetch->data), static_cast<std::size_t>(fetch->numBytes));
+                if (context->range && fetch->status != 206) { // server ignored 'Range': copy only the window of the full body
+                    const auto [offset, count] = context->range->clampTo(body.size());
+                    body                       = body.subspan(offset, count);
+                }
+                auto bytes = ByteBuffer::copyOf(body);
+                if (!context->range && context->cache && UrlCache::cacheable(responseHeader(fetch, "cache-control"))) {
+                    context->cache->store(fetch->url, bytes, responseHeader(fetch, "etag"), responseHeader(fetch, "last-modified"), UrlCache::lifetimeOf(responseHeader(fetch, "cache-control"), responseHeader(fetch, "expires")));
+                }
+                FileIo::instance().pushUploadedFiles({FileData{.requestID = context->requestID, .name = std::string(fetch->url), .data = std::move(bytes)}});
             } catch (const std::exception& e) {
                 std::println("[FileIO] HttpLoad error: {}", e.what());
             }
@@ -65,8 +196,27 @@ std::vector<FileData> FileIo::triggerHttpLoad(std::size_t requestID, std::string
             emscripten_fetch_close(fetch);
             std::println("triggerHttpLoad after - main thread ID: {}", std::this_thread::get_id());
         };
+        attr.onerror = [](emscripten_fetch_t* fetch) { // N.B. emscripten_fetch reports every non-2xx status here, incl. 304
+            if (fetch->userData == nullptr) {
+                return; // aborted by abortFetch(), which closes the fetch
+            }
+            std::unique_ptr<FetchContext> context(static_cast<FetchContext*>(fetch->userData));
+            activeFetches.erase(context->requestID);
+            if (isCancelled(context->cancelled)) {
+                // dropped
+            } else if (fetch->status == 304 && context->cached) {
+                context->cache->refresh(fetch->url, UrlCache::lifetimeOf(responseHeader(fetch, "cache-control"), responseHeader(fetch, "expires")));
+                FileIo::instance().pushUploadedFiles({FileData{.requestID = context->requestID, .name = std::string(fetch->url), .data = std::move(context->cached->data)}});
+            } else if (fetch->status == 416 && context->range) { // range starts past the end -> empty window
+                FileIo::instance().pushUploadedFiles({FileData{.requestID = context->requestID, .name = std::string(fetch->url), .data = {}}});
+            } else {
+                FileIo::instance().failRequest(context->requestID, std::format("HTTP {} for '{}'", fetch->status, fetch->url));
+            }
+            emscripten_fetch_close(fetch);
+        };
+        attr.userData = context.release();
 
-        emscripten_fetch(&attr, url.data());
+        activeFetches.insert_or_assign(requestID, emscripten_fetch(&attr, url.data()));
     } else { // call from outside the main thread
         std::println("triggerHttpLoad outside - main thread ID: {}", std::this_thread::get_id());
         struct Args {
@@ -86,14 +236,402 @@ std::vector<FileData> FileIo::triggerHttpLoad(std::size_t requestID, std::string
     }
     return {};
 #else
-    throw std::runtime_error("No HttpLoadCallback registered"); // TODO: use HttpLib for this?
+    // native: blocking keep-alive client on a worker thread, completes the request asynchronously like emscripten_fetch
+    std::thread([this, requestID, url = std::string(url), cancelled = cancelFlagOf(requestID), range = takeRange(requestID)] {
+        try {
+            if (isCancelled(cancelled)) {
+                return;
+            }
+            if (range && range->length == 0U) {
+                pushUploadedFiles({FileData{.requestID = requestID, .name = url, .data = {}}});
+                return;
+            }
+            const auto                     cache  = urlCache();
+            std::optional<UrlCache::Entry> cached = cache ? cache->lookup(url) : std::nullopt;
+            if (cached && cached->fresh) { // no network access at all
+                pushUploadedFiles({FileData{.requestID = requestID, .name = url, .data = range ? window(cached->data, *range) : std::move(cached->data)}});
+                return;
+            }
+            if (range) {
+                cached.reset(); // a partial response cannot revalidate the whole entry
+            }
+
+            const http::Headers headers  = range ? rangeHeader(*range) : cached ? UrlCache::conditionalHeaders(*cached) : http::Headers{};
+            auto                response = _httpClient.get(url, headers, cancelled.get()); // aborts the transfer once cancelled
+            if (!response) {
+                failRequest(requestID, response.error());
+            } else if (response->status == 304 && cached) {
+                cache->refresh(url, UrlCache::lifetimeOf(response->header("cache-control"), response->header("expires")));
+                pushUploadedFiles({FileData{.requestID = requestID, .name = url, .data = std::move(cached->data)}});
+            } else if (response->status == 416 && range) { // range starts past the end -> empty window
+                pushUploadedFiles({FileData{.requestID = requestID, .name = url, .data = {}}});
+            } else if (response->status < 200 || response->status >= 300) {
+                failRequest(requestID, std::format("HTTP {} for '{}'", response->status, url));
+            } else {
+                ByteBuffer body(std::move(response->body));
+                if (range) {
+                    body = response->status == 206 ? std::move(body) : window(body, *range); // 200: server without range support
+                } else if (cache && UrlCache::cacheable(response->header("cache-control"))) {
+                    cache->store(url, body, response->header("etag"), response->header("last-modified"), UrlCache::lifetimeOf(response->header("cache-control"), response->header("expires")));
+                }
+                pushUploadedFiles({FileData{.requestID = requestID, .name = url, .data = std::move(body)}});
+            }
+        } catch (const std::exception& e) { // e.g. bad_alloc for a huge body: the request must still complete (the thread is detached)
+            failRequest(requestID, std::format("could not load '{}': {}", url, e.what()));
+        }
+    }).detach();
+    return {};
 #endif
 }
 
+void FileIo::enableUrlCache(UrlCache::Options options) {
+    auto             cache = std::make_shared<UrlCache>(std::move(options));
+    std::scoped_lock lock(_urlCacheMutex);
+    _urlCache = std::move(cache);
+}
+
+void FileIo::disableUrlCache() {
+    std::scoped_lock lock(_urlCacheMutex);
+    _urlCache.reset();
+}
+
+std::shared_ptr<UrlCache> FileIo::urlCache() const {
+    std::scoped_lock lock(_urlCacheMutex);
+    return _urlCache;
+}
+
+IoPool& FileIo::ioPool() {
+    std::scoped_lock lock(_ioPoolMutex);
+    if (!_ioPool) {
+        _ioPool = std::make_unique<IoPool>(_ioQueueDepth);
+    }
+    return *_ioPool;
+}
+
+WriteBehind& FileIo::writeBehind() {
+    std::scoped_lock lock(_writeBehindMutex);
+    if (!_writeBehind) {
+        _writeBehind = std::make_unique<WriteBehind>(_writeBehindOptions);
+    }
+    return *_writeBehind;
+}
+
+void FileIo::setWriteBehindOptions(WriteBehind::Options options) {
+    std::scoped_lock lock(_writeBehindMutex);
+    _writeBehindOptions = options;
+    if (_writeBehind) {
+        _writeBehind->setOptions(options);
+    }
+}
+
+void FileIo::flushWrites() {
+    WriteBehind* engine = nullptr; // N.B. lives as long as FileIo once created, flushed without blocking other writers' writeBehind()
+    {
+        std::scoped_lock lock(_writeBehindMutex);
+        engine = _writeBehind.get();
+    }
+    if (engine != nullptr) {
+        engine->flush();
+    }
+}
+
+WriteBehind::Statistics FileIo::writeStatistics() {
+    std::scoped_lock lock(_writeBehindMutex);
+    return _writeBehind ? _writeBehind->statistics() : WriteBehind::Statistics{};
+}
+
+void FileIo::setIoQueueDepth(std::size_t depth) {
+    std::scoped_lock lock(_ioPoolMutex);
+    _ioQueueDepth = depth;
+    if (_ioPool) {
+        _ioPool->setQueueDepth(depth);
+    }
+}
+
+void FileIo::failRequest(std::size_t requestID, std::string errorMsg) {
+    {
+        std::scoped_lock lock(_requestsMutex);
+        if (auto it = _pendingRequests.find(requestID); it != _pendingRequests.end()) { // otherwise cancelled: nothing to report
+            std::println(stderr, "[FileIO] request {} failed: {}", requestID, errorMsg);
+            it->second.completeWithError(std::move(errorMsg));
+            _pendingRequests.erase(it);
+            _ranges.erase(requestID);
+            _stages.erase(requestID);
+        }
+    }
+    settleInFlight(requestID, nullptr);
+}
+
+std::optional<ByteRange> FileIo::takeRange(std::size_t requestID) {
+    std::scoped_lock lock(_requestsMutex);
+    if (auto range = _ranges.extract(requestID)) {
+        return range.mapped();
+    }
+    return std::nullopt;
+}
+
+CancelFlag FileIo::cancelFlagOf(std::size_t requestID) {
+    static const auto abandoned = std::make_shared<const std::atomic<bool>>(true);
+    std::scoped_lock  lock(_requestsMutex);
+    auto              it = _pendingRequests.find(requestID);
+    return it != _pendingRequests.end() ? it->second.cancelFlag() : abandoned;
+}
+
+bool FileIo::cancel(std::size_t requestID, std::string reason) {
+    bool pending = true;
+    {
+        std::scoped_lock lock(_requestsMutex);
+        auto             it = _pendingRequests.find(requestID);
+        if (it != _pendingRequests.end()) {
+            it->second._state->cancelled.store(true, std::memory_order_release); // before completing: loaders drop late results
+            it->second.completeWithError(std::move(reason));
+            _pendingRequests.erase(it);
+            _ranges.erase(requestID);
+            _stages.erase(requestID);
+        } else {
+            pending = false; // completed, or an item of a Batch (those are never in _pendingRequests)
+        }
+    }
+    if (!pending) {
+        return cancelBatchItem(requestID, std::move(reason));
+    }
+    settleInFlight(requestID, nullptr); // the next loadFile() of the same source starts a fresh load
+#ifdef __EMSCRIPTEN__
+    if (emscripten_is_main_runtime_thread()) {
+        abortFetch(requestID);
+    } else {
+        emscripten_async_run_in_main_runtime_thread(EM_FUNC_SIG_VI, +[](void* id) { abortFetch(reinterpret_cast<std::size_t>(id)); }, reinterpret_cast<void*>(requestID));
+    }
+#endif
+    return true;
+}
+
+bool FileIo::cancelBatchItem(std::size_t requestID, std::string reason) {
+    std::shared_ptr<Batch::State> batch;
+    std::size_t                   index = 0UZ;
+    std::optional<Request>        load;
+    {
+        std::scoped_lock lock(_batchMutex);
+        auto             it = _batchItems.find(requestID);
+        if (it == _batchItems.end()) {
+            return false; // unknown or completed
+        }
+        batch = it->second.first;
+        index = it->second.second;
+        load  = batch->loads[index];
+    }
+    batch->items[index]._state->cancelled.store(true, std::memory_order_release);
+    bool shared = false;
+    if (load) {
+        std::scoped_lock lock(_assetMutex);
+        shared = load->_state->handles > 1UZ;
+        if (auto it = _inFlightKeys.find(load->requestID()); !shared && it != _inFlightKeys.end()) { // no loadFile() may join it from now on
+            _inFlight.erase(it->second);
+            _inFlightKeys.erase(it);
+        }
+    }
+    // sole holder: abort the transfer (its continuation finds the item settled), otherwise only detach the item from the shared load
+    const bool aborted = load && !shared && cancel(load->requestID(), reason);
+    return completeBatchItem(batch, index, std::unexpected(std::move(reason))) || aborted; // still queued: skipped by dispatchBatchJobs()
+}
+
+void FileIo::cancelAt(std::size_t requestID, std::chrono::steady_clock::time_point deadline) {
+    {
+        std::scoped_lock lock(_deadlineMutex);
+        _deadlines.emplace(deadline, requestID);
+        if (!_deadlineWatchdog.joinable()) {
+            _deadlineWatchdog = std::jthread([this](std::stop_token stop) { runDeadlineWatchdog(std::move(stop)); });
+        }
+    }
+    _deadlineChanged.notify_one();
+}
+
+void FileIo::runDeadlineWatchdog(std::stop_token stop) {
+    std::unique_lock lock(_deadlineMutex);
+    while (!stop.stop_requested()) {
+        if (_deadlines.empty()) {
+            _deadlineChanged.wait(lock, stop, [this] { return !_deadlines.empty(); });
+            continue;
+        }
+        const auto [deadline, requestID] = _deadlines.top();
+        if (std::chrono::steady_clock::now() < deadline) {
+            _deadlineChanged.wait_until(lock, stop, deadline, [this, deadline] { return _deadlines.top().first < deadline; }); // or an earlier one was added
+            continue;
+        }
+        _deadlines.pop();
+        lock.unlock();
+        if (cancel(requestID, "deadline exceeded")) { // no-op for completed requests
+            std::println(stderr, "[FileIO] request {} cancelled: deadline exceeded", requestID);
+        }
+        lock.lock();
+    }
+}
+
+bool Request::cancel() { return FileIo::instance().cancel(requestID()); }
+
+Request& Request::cancelAt(std::chrono::steady_clock::time_point deadline) {
+    if (!ready()) {
+        FileIo::instance().cancelAt(requestID(), deadline);
+    }
+    return *this;
+}
+
+void FileIo::settleInFlight(std::size_t requestID, const std::vector<FileData>* files) {
+    std::scoped_lock lock(_assetMutex);
+    auto             it = _inFlightKeys.find(requestID);
+    if (it == _inFlightKeys.end()) {
+        return; // picker upload, cache hit or custom push
+    }
+    if (files != nullptr) {
+        std::size_t bytes = 0UZ;
+        for (const FileData& file : *files) {
+            bytes += file.data.size();
+        }
+        _assetCache.insert(it->second, *files, bytes);
+    }
+    _inFlight.erase(it->second);
+    _inFlightKeys.erase(it);
+}
+
+Batch FileIo::loadBatch(std::vector<BatchSource> sources) {
+    auto nextRequest = [this] { return Request(_requestID.fetch_add(1UZ, std::memory_order_relaxed)); };
+    std::vector<Request> items;
+    items.reserve(sources.size());
+    for (std::size_t i = 0UZ; i < sources.size(); ++i) {
+        items.push_back(nextRequest());
+    }
+    auto batch = std::make_shared<Batch::State>(std::move(items), nextRequest(), nextRequest());
+    if (sources.empty()) {
+        batch->all.complete({});
+        batch->any.completeWithError("empty batch");
+        return Batch(std::move(batch));
+    }
+
+    std::vector<std::size_t> invalid;
+    {
+        std::scoped_lock lock(_batchMutex);
+        for (std::size_t i = 0UZ; i < sources.size(); ++i) {
+            if (sources[i].source.empty()) {
+                invalid.push_back(i);
+                continue;
+            }
+            _batchItems.emplace(batch->items[i].requestID(), std::pair(batch, i));
+            _batchQueue.push(BatchJob{.priority = sources[i].priority, .sequence = _batchSequence++, .source = std::move(sources[i].source), .mode = sources[i].mode, .batch = batch, .index = i});
+        }
+    }
+    for (const std::size_t i : invalid) {
+        completeBatchItem(batch, i, std::unexpected("batch sources must be a URL or path (the browser picker is not supported)"));
+    }
+    dispatchBatchJobs();
+    return Batch(std::move(batch));
+}
+
+void FileIo::setBatchConcurrency(std::size_t maxConcurrent) {
+    {
+        std::scoped_lock lock(_batchMutex);
+        _batchConcurrency = std::max(maxConcurrent, 1UZ);
+    }
+    dispatchBatchJobs();
+}
+
+void FileIo::dispatchBatchJobs() {
+    std::vector<BatchJob> ready;
+    {
+        std::scoped_lock lock(_batchMutex);
+        while (_batchActive < _batchConcurrency && !_batchQueue.empty()) {
+            BatchJob job = _batchQueue.top(); // N.B. top() is const -> copy, the payload is small
+            _batchQueue.pop();
+            if (job.batch->settled[job.index].load(std::memory_order_acquire)) {
+                continue; // cancelled while queued
+            }
+            ready.push_back(std::move(job));
+            ++_batchActive;
+        }
+    }
+    for (BatchJob& job : ready) {
+        Request load = loadFile(job.source, "", false, job.mode);
+        {
+            std::scoped_lock lock(_batchMutex);
+            if (!job.batch->settled[job.index].load(std::memory_order_acquire)) {
+                job.batch->loads[job.index] = load; // cancel() of the item is forwarded to it from now on
+            }
+        }
+        // the slot is released by the continuation (on a Scheduler worker, i.e. also for loads that complete synchronously)
+        load.then([this, batch = std::move(job.batch), index = job.index](const Request::DataStoreType& result) {
+            completeBatchItem(batch, index, result);
+            {
+                std::scoped_lock lock(_batchMutex);
+                --_batchActive;
+            }
+            dispatchBatchJobs();
+        }, Executor::Worker);
+    }
+}
+
+bool FileIo::completeBatchItem(const std::shared_ptr<Batch::State>& batch, std::size_t index, const Request::DataStoreType& result) {
+    if (batch->settled[index].exchange(true, std::memory_order_acq_rel)) {
+        return false; // cancelled before its load returned (or vice versa)
+    }
+    Request& item = batch->items[index];
+    {
+        std::scoped_lock lock(_batchMutex);
+        _batchItems.erase(item.requestID());
+        batch->loads[index].reset();
+    }
+    if (result) {
+        item.complete(*result);
+        if (!batch->anySettled.exchange(true, std::memory_order_acq_rel)) {
+            batch->any.complete(*result);
+        }
+    } else {
+        item.completeWithError(result.error());
+    }
+    if (batch->remaining.fetch_sub(1UZ, std::memory_order_acq_rel) != 1UZ) {
+        return true;
+    }
+
+    // last one: every item's result is final and visible here
+    std::vector<FileData> files;
+    std::string           errors;
+    for (Request& each : batch->items) {
+        if (const auto& itemResult = each.get(); itemResult) {
+            files.insert(files.end(), itemResult->begin(), itemResult->end());
+        } else {
+            errors += errors.empty() ? itemResult.error() : std::format("; {}", itemResult.error());
+        }
+    }
+    if (errors.empty()) {
+        batch->all.complete(std::move(files));
+    } else {
+        batch->all.completeWithError(std::move(errors));
+    }
+    if (!batch->anySettled.exchange(true, std::memory_order_acq_rel)) {
+        batch->any.completeWithError(std::format("all {} sources failed", batch->items.size()));
+    }
+    return true;
+}
+
+void FileIo::setAssetCacheBudget(std::size_t bytes) {
+    std::scoped_lock lock(_assetMutex);
+    _assetCache.setBudget(bytes);
+}
+
+void FileIo::invalidateAsset(std::string_view source) {
+    const std::string key = normaliseSource(source);
+    std::scoped_lock  lock(_assetMutex);
+    _assetCache.eraseIf([&key](const std::string& cached) { return cached.starts_with(key) && (cached.size() == key.size() || cached[key.size()] == '\n'); }); // incl. ranged loads
+}
+
+FileIo::AssetCacheStatistics FileIo::assetCacheStatistics() {
+    std::scoped_lock lock(_assetMutex);
+    return {.cache = _assetCache.statistics(), .coalesced = _coalesced, .inFlight = _inFlight.size()};
+}
+
 std::vector<FileData> FileIo::triggerFileUpload(std::size_t requestID, std::string_view accept, bool multipleFiles) {
 #ifdef __EMSCRIPTEN__
     if (emscripten_is_main_runtime_thread()) {
         std::println("triggerFileUpload - main thread ID: {}", std::this_thread::get_id());
+        const ByteRange range = takeRange(requestID).value_or(ByteRange{}); // windowed in the browser: only the range is read
 
         // clang-format off
         EM_ASM(
@@ -101,6 +639,8 @@ std::vector<FileData> FileIo::triggerFileUpload(std::size_t requestID, std::stri
                 const requestId     = $0;
                 const acceptFilter  = UTF8ToString($1);
                 const allowMultiple = $2;
+                const rangeOffset   = $3;
+                const rangeLength   = $4; // < 0: to the end of each file
 
                 const input    = document.createElement('input');
                 input.type     = 'file';
@@ -116,64 +656,79 @@ std::vector<FileData> FileIo::triggerFileUpload(std::size_t requestID, std::stri
                         return;
                     }
 
-                    let totalSize = 4;
-                    for (let i = 0; i < files.length; ++i) {
-                        totalSize += 4 + 4; // nameLen + dataLen
-                        totalSize += (new TextEncoder()).encode(files[i].name).length;
-                        totalSize += files[i].size;
-                    }
-
-                    // Buffer Layout (binary format):
+                    // Buffer Layout (binary format, see file::parseUploadedFiles):
                     //   [uint32_t numFiles]
                     //   For each file:
                     //     [uint32_t nameLength]
                     //     [uint32_t dataLength]
                     //     [uint8_t nameBytes[nameLength]]   (UTF-8 encoded filename)
                     //     [uint8_t fileData[dataLength]]    (raw file content)
+                    //
+                    // all sizes are known upfront -> the buffer is allocated once on the C++ heap, each file's record gets a fixed
+                    // offset and FileReaders write straight into it in whatever order they complete. Ownership of the buffer is
+                    // handed over to handle_uploaded_files() which slices it into the FileData entries without further copies.
+                    const encoder   = new TextEncoder();
+                    const nameBytes = Array.from(files, (file) => encoder.encode(file.name));
+                    const parts     = Array.from(files, (file) => file.slice(rangeOffset, rangeLength >= 0 ? rangeOffset + rangeLength : undefined)); // Blob views, no read yet
 
-                    const buffer = new Uint8Array(totalSize);
-                    const view   = new DataView(buffer.buffer);
-
-                    let offset = 0;
-                    view.setUint32(offset, files.length, true);
-                    offset += 4;
+                    let totalSize = 4;
+                    for (let i = 0; i < files.length; ++i) {
+                        totalSize += 4 + 4 + nameBytes[i].length + parts[i].size;
+                    }
 
-                    const encoder = new TextEncoder();
+                    const ptr = Module._malloc(totalSize);
+                    if (!ptr) {
+                        console.error("[FileIO] Could not allocate " + totalSize + " bytes for the upload.");
+                        return;
+                    }
+                    new DataView(Module.HEAPU8.buffer).setUint32(ptr, files.length, true);
 
                     let readersRemaining = files.length;
+                    let failed           = false;
+                    const finish         = () => {
+                        if (--readersRemaining > 0) {
+                            return;
+                        }
+                        if (failed) {
+                            Module._free(ptr);
+                            return;
+                        }
+                        Module.ccall('handle_uploaded_files', null, [ 'number', 'number', 'number' ], [ requestId, ptr, totalSize ]); // takes ownership of 'ptr'
+                    };
+
+                    let offset = ptr + 4;
                     for (let i = 0; i < files.length; ++i) {
-                        const file   = files[i];
-                        const reader = new FileReader();
-
-                        reader.onload = ((file) => (e) => {
-                            const nameBytes = encoder.encode(file.name);
-                            const dataBytes = new Uint8Array(e.target.result);
-
-                            view.setUint32(offset, nameBytes.length, true);
-                            offset += 4;
-                            view.setUint32(offset, dataBytes.length, true);
-                            offset += 4;
-                            buffer.set(nameBytes, offset);
-                            offset += nameBytes.length;
-                            buffer.set(dataBytes, offset);
-                            offset += dataBytes.length;
-
-                            readersRemaining--;
-                            if (readersRemaining === 0) {
-                                const ptr = Module._malloc(buffer.length);
-                                Module.HEAPU8.set(buffer, ptr);
-                                Module.ccall('handle_uploaded_files', null, [ 'number', 'number', 'number' ], [ requestId, ptr, buffer.length ]);
-                                Module._free(ptr);
-                            }
-                        })(file);
+                        const record = offset;
+                        offset += 4 + 4 + nameBytes[i].length + parts[i].size;
 
-                        reader.readAsArrayBuffer(file);
+                        const reader  = new FileReader();
+                        reader.onload = (e) => {
+                            if (e.target.result.byteLength !== parts[i].size) { // file modified since selection -> would overrun its record
+                                console.error("[FileIO] Size of '" + files[i].name + "' changed while reading.");
+                                failed = true;
+                                finish();
+                                return;
+                            }
+                            const heap = Module.HEAPU8; // N.B. re-acquire the view: the heap may have grown (ALLOW_MEMORY_GROWTH) meanwhile
+                            const view = new DataView(heap.buffer);
+                            view.setUint32(record, nameBytes[i].length, true);
+                            view.setUint32(record + 4, parts[i].size, true);
+                            heap.set(nameBytes[i], record + 8);
+                            heap.set(new Uint8Array(e.target.result), record + 8 + nameBytes[i].length);
+                            finish();
+                        };
+                        reader.onerror = () => {
+                            console.error("[FileIO] Could not read '" + files[i].name + "': " + reader.error);
+                            failed = true;
+                            finish();
+                        };
+                        reader.readAsArrayBuffer(parts[i]);
                     }
                 };
 
                 input.click();
             },
-            requestID, accept.data(), multipleFiles
+            requestID, accept.data(), multipleFiles, static_cast<double>(range.offset), range.length == ByteRange::kToEnd ? -1.0 : static_cast<double>(range.length)
         );
         // clang-format on
     } else {
@@ -203,14 +758,48 @@ std::vector<FileData> FileIo::triggerFileUpload(std::size_t requestID, std::stri
 #endif
 }
 
-[[maybe_unused]] Request FileIo::loadFile(std::string_view source, std::string_view acceptedFileExtensions, bool acceptMultipleFiles) {
-    Request request(_requestID.fetch_add(1UZ, std::memory_order_relaxed));
+[[maybe_unused]] Request FileIo::loadFile(std::string_view source, std::string_view acceptedFileExtensions, bool acceptMultipleFiles, LoadMode mode) { return startLoad(source, acceptedFileExtensions, acceptMultipleFiles, mode, ByteRange{}); }
+
+[[maybe_unused]] Request FileIo::loadFileRange(std::string_view source, ByteRange range, std::string_view acceptedFileExtensions, bool acceptMultipleFiles, LoadMode mode) { return startLoad(source, acceptedFileExtensions, acceptMultipleFiles, mode, range); }
+
+Request FileIo::startLoad(std::string_view source, std::string_view acceptedFileExtensions, bool acceptMultipleFiles, LoadMode mode, ByteRange range) {
+    Request               request(_requestID.fetch_add(1UZ, std::memory_order_relaxed));
+    std::vector<FileData> cached;
+    const bool            decode = range.whole() && _decompress.load(std::memory_order_relaxed);
+    if (!source.empty()) {
+        std::string      key = decode ? std::format("{}\ndecompressed", normaliseSource(source)) : rangeKey(normaliseSource(source), range); // raw and decoded results are memoised apart
+        std::scoped_lock lock(_assetMutex);
+        if (auto it = _inFlight.find(key); it != _inFlight.end()) {
+            ++_coalesced;
+            ++it->second._state->handles;
+            return it->second; // join the running load
+        }
+        if (const auto* files = _assetCache.find(key)) {
+            cached = *files; // shares the buffers
+        } else {
+            _inFlightKeys.emplace(request.requestID(), key);
+            _inFlight.emplace(std::move(key), request);
+        }
+    }
     {
         std::scoped_lock lock(_requestsMutex);
         _pendingRequests.emplace(request.requestID(), request);
+        if (!range.whole() && (source.empty() || isUrl(source))) { // applied by the loader (takeRange()) or by pushUploadedFiles()
+            _ranges.emplace(request.requestID(), range);
+        }
+        if (const Stages stages{.decompress = decode, .deduplicate = (source.empty() || isUrl(source)) && _deduplicate.load(std::memory_order_relaxed)}; cached.empty() && (stages.decompress || stages.deduplicate)) { // cached files went through them already
+            _stages.emplace(request.requestID(), stages);
+        }
     }
 
-    constexpr auto startsWith = [](std::string_view source, std::string_view prefix) -> bool { return source.size() >= prefix.size() && std::ranges::equal(prefix, source.substr(0, prefix.size()), [](char a, char b) { return std::tolower(a) == std::tolower(b); }); };
+    if (!cached.empty()) {
+        for (FileData& file : cached) {
+            file.requestID      = request.requestID();
+            file.decompressTime = {}; // decoded by an earlier load
+        }
+        pushUploadedFiles(std::move(cached)); // completes right away, delivered like a fresh load
+        return request;
+    }
 
     if (source.empty()) {
         if (_fileDialog) {
@@ -218,99 +807,446 @@ std::vector<FileData> FileIo::triggerFileUpload(std::size_t requestID, std::stri
         } else {
             std::println("[FileIO] No file dialog callback configured.");
         }
-    } else if (startsWith(source, "http://") || startsWith(source, "https://")) {
+    } else if (isUrl(source)) {
         if (_httpLoader) {
             FileIo::instance().pushUploadedFiles(_httpLoader(request.requestID(), source, acceptedFileExtensions, acceptMultipleFiles));
         } else {
             std::println("[FileIO] No HTTP loader callback configured.");
         }
     } else {
-        try {
-            std::ifstream in(std::string(source), std::ios::binary);
-            if (!in) {
-                throw std::runtime_error("File open failed");
+        auto onLoaded = [this, requestID = request.requestID(), path = std::string(source)](ReadResult&& data) {
+            if (data) {
+                pushUploadedFiles({FileData{.requestID = requestID, .name = path, .data = std::move(*data)}});
+            } else {
+                failRequest(requestID, std::move(data.error()));
             }
-            std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), {});
-            FileIo::instance().pushUploadedFiles({FileData{.requestID = request.requestID(), .name = std::string(source), .data = std::move(data)}});
-        } catch (const std::exception& e) {
-            std::println("[FileIO] Error loading file: {}", e.what());
-        }
+        };
+#ifdef __EMSCRIPTEN__
+        onLoaded(loadLocalFile(std::string(source), mode, range)); // in-memory virtual file system, FS calls from workers would be proxied to this thread anyway
+#else
+        ioPool().submit(std::string(source), mode, std::move(onLoaded), request.cancelFlag(), range); // returns immediately, completes on an I/O thread
+#endif
     }
     return request;
 }
 
-void FileIo::processPendingWrites() {
-    if (!isMainThread()) {
+void FileIo::pushUploadedFiles(std::vector<FileData> files) noexcept {
+    if (files.empty()) {
+        return;
+    }
+    const std::size_t requestID = files[0UZ].requestID;
+    const std::string firstName = files[0UZ].name;
+    std::optional<Stages>  stages;
+    std::optional<Request> completed;
+    {
+        std::scoped_lock lock(_requestsMutex);
+        auto             it = _pendingRequests.find(requestID);
+        if (it == _pendingRequests.end()) {
+            std::println("pushUploadedFiles: No matching request for ID {}", requestID);
+            return;
+        }
+        auto pending = _stages.extract(requestID);
+        if (pending && (pending.mapped().deduplicate || std::ranges::any_of(files, [](const FileData& file) { const Compression compression = detectCompression(file.data); return compression != Compression::None && canDecompress(compression); }))) {
+            stages = pending.mapped(); // completed by the second push of the processed files
+        } else {
+            std::println("pushUploadedFiles: Matching request for ID {}", requestID);
+            if (auto range = _ranges.extract(requestID)) { // custom loader delivered whole files -> window them (shares the buffers)
+                for (FileData& file : files) {
+                    file.data = window(file.data, range.mapped());
+                }
+            }
+            it->second.complete(files);
+            completed.emplace(std::move(it->second));
+            _pendingRequests.erase(it);
+        }
+    }
+    if (stages) {
+        runStages(std::move(files), *stages);
         return;
     }
-    while (!_pendingWrites.empty()) {
-        if (auto task = _pendingWrites.pop_front(); task) {
-            writeFile(task->name, task->data);
+    settleInFlight(requestID, &files);
+
+    const std::size_t nFiles = files.size();
+    if (!completed->_state->observed.load()) { // otherwise the then()/co_await consumer owns the result, nobody polls for it
+        auto push = [&](Mailbox& mailbox) { mailbox.files.push_range(std::move(files)); }; // single publish for the whole batch
+        {
+            std::shared_lock lock(_mailboxMutex); // N.B. pushes happen under the shared lock, thus a mailbox cannot be erased mid-push
+            if (auto it = _mailboxes.find(requestID); it != _mailboxes.end()) {
+                push(*it->second);
+                files.clear();
+            }
+        }
+        if (!files.empty()) {
+            std::unique_lock lock(_mailboxMutex);
+            auto [it, inserted] = _mailboxes.try_emplace(requestID, std::make_shared<Mailbox>(_mailboxSequence));
+            if (inserted) {
+                _deliveries.emplace(_mailboxSequence++, requestID);
+            }
+            push(*it->second);
+        }
+        if (completed->_state->observed.load()) { // then()/co_await registered meanwhile and found no mailbox yet (pairs with Request::observe())
+            releaseMailbox(requestID);
         }
     }
+    _updateCounter.fetch_add(nFiles, std::memory_order_relaxed);
+    _updateCounter.notify_all();
+
+    std::println("pushUploadedFiles: notify file upload: {} - counter: {}", firstName, _updateCounter.load());
 }
 
-} // namespace file
+void FileIo::runStages(std::vector<FileData> files, Stages stages) {
+    Scheduler::instance().post(Executor::Worker, [this, files = std::move(files), stages]() mutable {
+        const std::size_t requestID = files[0UZ].requestID;
+        const CancelFlag  cancelled = cancelFlagOf(requestID);
+        try {
+            for (FileData& file : files) {
+                if (isCancelled(cancelled)) {
+                    return;
+                }
+                if (const Compression compression = detectCompression(file.data); stages.decompress && compression != Compression::None && canDecompress(compression)) {
+                    const auto start   = std::chrono::steady_clock::now();
+                    auto       decoded = decompress(file.data, compression);
+                    if (decoded) {
+                        file.data           = std::move(*decoded); // releases the compressed bytes (unless shared by another holder)
+                        file.name           = std::string(stripCompressionSuffix(file.name));
+                        file.decompressTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                    } else { // magic bytes by chance or a corrupt stream: deliver the bytes as loaded
+                        std::println(stderr, "[FileIO] could not decompress '{}' ({}) - delivered as is", file.name, decoded.error());
+                    }
+                }
+                if (stages.deduplicate) {
+                    file.data = _blobStore.intern(std::move(file.data)); // a duplicate is released here, the request gets the stored blob
+                }
+            }
+        } catch (const std::exception& e) { // e.g. bad_alloc for a huge output: the request (and joined loads) must still complete
+            failRequest(requestID, std::format("could not process '{}': {}", files[0UZ].name, e.what()));
+            return;
+        }
+        pushUploadedFiles(std::move(files));
+    });
+}
+
+std::size_t FileIo::drainMailbox(std::size_t requestID, std::vector<FileData>& out) {
+    std::shared_ptr<Mailbox> mailbox;
+    {
+        std::shared_lock lock(_mailboxMutex);
+        if (auto it = _mailboxes.find(requestID); it != _mailboxes.end()) {
+            mailbox = it->second;
+        }
+    }
+    if (!mailbox || mailbox->draining.test_and_set(std::memory_order_acquire)) {
+        return 0UZ; // nothing delivered (yet) or drained by another thread right now
+    }
+
+    const std::size_t initialSize = out.size();
+    std::size_t       n           = initialSize;
+    do {
+        out.resize(n + kPollBatchSize);
+        n += mailbox->files.pop_into(std::span(out).subspan(n));
+    } while (n == out.size());
+    out.resize(n);
 
+    std::size_t highWaterMark = _mailboxHighWaterMark.load(std::memory_order_relaxed);
+    while (mailbox->files.highWaterMark() > highWaterMark && !_mailboxHighWaterMark.compare_exchange_weak(highWaterMark, mailbox->files.highWaterMark(), std::memory_order_relaxed)) {
+    }
+
+    {
+        std::unique_lock lock(_mailboxMutex); // no push in flight -> an empty mailbox can be released safely
+        if (mailbox->files.empty() && _mailboxes.erase(requestID) != 0UZ) {
+            _deliveries.erase(mailbox->sequence);
+        }
+    }
+    mailbox->draining.clear(std::memory_order_release);
+    return n - initialSize; // files appended by this call
+}
+
+void FileIo::releaseMailbox(std::size_t requestID) {
+    std::shared_ptr<Mailbox> mailbox; // destroyed (with the pinned payloads) after unlocking
+    std::unique_lock         lock(_mailboxMutex);
+    if (auto it = _mailboxes.find(requestID); it != _mailboxes.end()) {
+        mailbox = std::move(it->second);
+        _deliveries.erase(mailbox->sequence);
+        _mailboxes.erase(it);
+    }
+}
+
+void Request::observe(const std::shared_ptr<SharedState>& state) {
+    if (!state->observed.exchange(true)) { // N.B. seq_cst: either this or pushUploadedFiles()' re-check sees the mailbox
+        FileIo::instance().releaseMailbox(state->requestID);
+    }
+}
+
+FileStream FileIo::loadFileStream(std::string_view source, std::size_t chunkSize, [[maybe_unused]] std::string_view acceptedFileExtensions, [[maybe_unused]] bool acceptMultipleFiles) {
+    auto state = std::make_shared<StreamState>(_requestID.fetch_add(1UZ, std::memory_order_relaxed), std::max(chunkSize, 1UZ));
+    if (source.empty()) {
 #ifdef __EMSCRIPTEN__
-extern "C" void handle_uploaded_files(std::size_t requestID, const uint8_t* buffer, int length) {
-    if (!buffer || length <= 0) {
-        std::println("[FileIO] Invalid uploaded files buffer.");
-        return;
+        {
+            std::scoped_lock lock(_streamsMutex);
+            std::erase_if(_streams, [](const auto& entry) { return entry.second.expired(); });
+            _streams.emplace(state->streamID, state);
+        }
+        triggerStreamUpload(state->streamID, state->chunkSize, acceptedFileExtensions, acceptMultipleFiles);
+#else
+        state->finish("streaming from a file dialog is not available on native builds");
+#endif
+    } else if (isUrl(source)) {
+        state->finish(std::format("streaming is not supported for URLs: '{}'", source));
+    } else {
+        std::thread([state, path = std::string(source)] { readFileStream(state, path); }).detach(); // owns 'state' until finished or cancelled
     }
+    return FileStream(std::move(state));
+}
 
-    // Buffer Layout (binary format):
-    //   [uint32_t numFiles]
-    //   For each file:
-    //     [uint32_t nameLength]
-    //     [uint32_t dataLength]
-    //     [uint8_t nameBytes[nameLength]]   (UTF-8 encoded filename)
-    //     [uint8_t fileData[dataLength]]    (raw file content)
-    const uint8_t* ptr = buffer;
-    const uint8_t* end = buffer + length;
+std::shared_ptr<StreamState> FileIo::findStream(std::size_t streamID) {
+    std::scoped_lock lock(_streamsMutex);
+    auto             it = _streams.find(streamID);
+    return it != _streams.end() ? it->second.lock() : nullptr;
+}
+
+void FileIo::triggerStreamUpload([[maybe_unused]] std::size_t streamID, [[maybe_unused]] std::size_t chunkSize, [[maybe_unused]] std::string_view accept, [[maybe_unused]] bool multipleFiles) {
+#ifdef __EMSCRIPTEN__
+    if (emscripten_is_main_runtime_thread()) {
+        // clang-format off
+        EM_ASM(
+            {
+                const streamId      = $0;
+                const chunkSize     = $1;
+                const acceptFilter  = UTF8ToString($2);
+                const allowMultiple = $3;
+
+                const input    = document.createElement('input');
+                input.type     = 'file';
+                input.multiple = allowMultiple;
+                if (acceptFilter.length > 0) {
+                    input.accept = acceptFilter;
+                }
+
+                input.onchange = async (e) => {
+                    const files = e.target.files;
+                    if (!files || (files.length === 0)) {
+                        Module.ccall('handle_stream_end', null, [ 'number', 'string' ], [ streamId, "no files selected" ]);
+                        return;
+                    }
+                    let totalBytes = 0;
+                    for (let i = 0; i < files.length; ++i) {
+                        totalBytes += files[i].size;
+                    }
+                    Module.ccall('handle_stream_begin', null, [ 'number', 'number' ], [ streamId, totalBytes ]);
+
+                    // reads one File.slice() at a time and only once C++ reported a free queue slot (back-pressure), i.e. the
+                    // JS side never holds more than one chunk and the C++ side at most StreamState::kDepth chunks
+                    const waitForRoom = () => new Promise((resolve) => {
+                        const poll = () => {
+                            const room = Module.ccall('handle_stream_room', 'number', [ 'number' ], [ streamId ]);
+                            if (room !== 0) {
+                                resolve(room > 0);
+                            } else {
+                                setTimeout(poll, 4);
+                            }
+                        };
+                        poll();
+                    });
+
+                    try {
+                        for (let i = 0; i < files.length; ++i) {
+                            const file = files[i];
+                            let offset = 0;
+                            do {
+                                if (!(await waitForRoom())) {
+                                    return; // cancelled by the consumer
+                                }
+                                const end   = Math.min(offset + chunkSize, file.size);
+                                const bytes = new Uint8Array(await file.slice(offset, end).arrayBuffer());
+                                const ptr   = Module._malloc(Math.max(bytes.length, 1));
+                                if (!ptr) {
+                                    throw new Error("could not allocate " + bytes.length + " bytes");
+                                }
+                                Module.HEAPU8.set(bytes, ptr);
+                                Module.ccall('handle_stream_chunk', null, [ 'number', 'number', 'string', 'number', 'number', 'number', 'number', 'number' ], [ streamId, i, file.name, offset, file.size, ptr, bytes.length, end === file.size ? 1 : 0 ]); // takes ownership of 'ptr'
+                                offset = end;
+                            } while (offset < file.size);
+                        }
+                        Module.ccall('handle_stream_end', null, [ 'number', 'string' ], [ streamId, "" ]);
+                    } catch (err) {
+                        console.error("[FileIO] stream read failed: ", err);
+                        Module.ccall('handle_stream_end', null, [ 'number', 'string' ], [ streamId, String(err) ]);
+                    }
+                };
+
+                input.click();
+            },
+            streamID, static_cast<int>(chunkSize), accept.data(), multipleFiles
+        );
+        // clang-format on
+    } else {
+        struct Args {
+            std::size_t streamID;
+            std::size_t chunkSize;
+            std::string accept;
+            bool        multiple;
+        };
+
+        emscripten_async_run_in_main_runtime_thread(
+            EM_FUNC_SIG_VI,
+            +[](void* voidPtr) {
+                std::unique_ptr<Args> a(static_cast<Args*>(voidPtr));
+                FileIo::instance().triggerStreamUpload(a->streamID, a->chunkSize, a->accept, a->multiple);
+            },
+            new Args{streamID, chunkSize, std::string(accept), multipleFiles}
+        );
+    }
+#endif
+}
 
-    auto read_uint32 = [&ptr, end]() -> uint32_t {
-        if (ptr + sizeof(uint32_t) > end) {
+std::vector<FileData> FileIo::pollUploadedFile(std::optional<std::size_t> requestID) noexcept {
+    std::vector<FileData> files;
+    if (requestID.has_value()) {
+        drainMailbox(*requestID, files);
+        return files;
+    }
+
+    if (_pollingAll.test_and_set(std::memory_order_acquire)) {
+        return files; // another thread polls all right now
+    }
+    std::vector<std::size_t> delivered;
+    {
+        std::shared_lock lock(_mailboxMutex);
+        delivered.reserve(_deliveries.size());
+        for (const auto& [sequence, deliveredID] : _deliveries) {
+            delivered.push_back(deliveredID);
+        }
+    }
+    for (const std::size_t deliveredID : delivered) {
+        drainMailbox(deliveredID, files); // no-op if that request has been polled by ID or released meanwhile
+    }
+    _pollingAll.clear(std::memory_order_release);
+    return files;
+}
+
+std::size_t FileIo::processPendingWrites(std::chrono::microseconds budget) {
+    if (!isMainThread()) {
+        return 0UZ; // e.g. writeFile<Sync>() on a worker: only the main thread drains (and touches the statistics)
+    }
+    if (_pendingWrites.empty()) {
+        _drainStatistics.backlog     = 0UZ;
+        _drainStatistics.lastDrained = 0UZ;
+        return 0UZ;
+    }
+    const auto  start   = std::chrono::steady_clock::now();
+    auto        elapsed = std::chrono::microseconds(0);
+    std::size_t n       = 0UZ;
+    _drainStatistics.backlog     = _pendingWrites.size();
+    _drainStatistics.peakBacklog = std::max(_drainStatistics.peakBacklog, _drainStatistics.backlog);
+    do { // at least one write per call, even with a zero budget, so the queue always makes progress
+        auto task = _pendingWrites.pop_front();
+        if (!task) {
+            break;
+        }
+        writeFile(task->name, std::move(task->data));
+        ++n;
+        elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    } while (elapsed < budget);
+    if (elapsed >= budget && !_pendingWrites.empty()) {
+        ++_drainStatistics.deferred;
+    }
+    _drainStatistics.lastDrained   = n;
+    _drainStatistics.lastDrainTime = elapsed;
+    _drainStatistics.maxDrainTime  = std::max(_drainStatistics.maxDrainTime, elapsed);
+    return n;
+}
+
+std::vector<FileData> parseUploadedFiles(std::size_t requestID, const ByteBuffer& buffer) {
+    std::size_t offset = 0UZ;
+
+    auto read_uint32 = [&buffer, &offset]() -> uint32_t {
+        if (buffer.size() - offset < sizeof(uint32_t)) {
             throw std::runtime_error("Unexpected end of buffer while reading uint32_t");
         }
         uint32_t value;
-        std::memcpy(&value, ptr, sizeof(uint32_t));
-        ptr += sizeof(uint32_t);
+        std::memcpy(&value, buffer.data() + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
         return value;
     };
 
-    auto read_bytes = [&ptr, end](std::size_t count) -> std::vector<uint8_t> {
-        if (ptr + count > end) {
+    auto read_bytes = [&buffer, &offset](std::size_t count) -> ByteBuffer {
+        if (buffer.size() - offset < count) {
             throw std::runtime_error("Unexpected end of buffer while reading bytes");
         }
-        std::vector<uint8_t> result(ptr, ptr + count);
-        ptr += count;
+        ByteBuffer result = buffer.slice(offset, count); // view, shares ownership with 'buffer'
+        offset += count;
         return result;
     };
 
-    try {
-        uint32_t                    numFiles = read_uint32();
-        std::vector<file::FileData> files;
-        files.reserve(numFiles);
+    const uint32_t        numFiles = read_uint32();
+    std::vector<FileData> files;
+    files.reserve(std::min<std::size_t>(numFiles, buffer.size() / (2UZ * sizeof(uint32_t)))); // N.B. do not trust the header for the allocation
 
-        for (uint32_t i = 0; i < numFiles; ++i) {
-            uint32_t nameLen = read_uint32();
-            uint32_t dataLen = read_uint32();
+    for (uint32_t i = 0; i < numFiles; ++i) {
+        uint32_t nameLen = read_uint32();
+        uint32_t dataLen = read_uint32();
 
-            auto name = read_bytes(nameLen);
-            auto data = read_bytes(dataLen);
+        auto name = read_bytes(nameLen);
+        auto data = read_bytes(dataLen);
 
-            files.push_back(file::FileData{
-                .requestID = requestID,
-                .name      = std::string(reinterpret_cast<const char*>(name.data()), name.size()),
-                .data      = std::move(data),
-            });
-        }
+        files.push_back(FileData{
+            .requestID = requestID,
+            .name      = std::string(reinterpret_cast<const char*>(name.data()), name.size()),
+            .data      = std::move(data),
+        });
+    }
+    return files;
+}
 
-        file::FileIo::instance().pushUploadedFiles(std::move(files));
+} // namespace file
 
+#ifdef __EMSCRIPTEN__
+extern "C" void handle_uploaded_files(std::size_t requestID, uint8_t* buffer, int length) {
+    if (!buffer || length <= 0) {
+        std::free(buffer);
+        std::println("[FileIO] Invalid uploaded files buffer.");
+        return;
+    }
+    // adopt the malloc'ed buffer from JS: the parsed FileData entries are slices of it, freed with the last reference
+    const ByteBuffer upload(std::shared_ptr<const void>(buffer, [](uint8_t* ptr) { std::free(ptr); }), std::span(buffer, static_cast<std::size_t>(length)));
+    try {
+        file::FileIo::instance().pushUploadedFiles(file::parseUploadedFiles(requestID, upload));
     } catch (const std::exception& e) {
         std::println("[FileIO] Error parsing uploaded files: {}", e.what());
     }
 }
-#endif
\ No newline at end of file
+
+extern "C" void handle_url_cache_loaded() {
+    if (auto cache = file::FileIo::instance().urlCache()) {
+        cache->reload();
+    }
+}
+
+extern "C" int handle_stream_room(std::size_t streamID) {
+    auto state = file::FileIo::instance().findStream(streamID);
+    return state ? state->room() : -1;
+}
+
+extern "C" void handle_stream_begin(std::size_t streamID, double totalBytes) {
+    if (auto state = file::FileIo::instance().findStream(streamID)) {
+        state->bytesTotal.store(static_cast<std::uint64_t>(totalBytes), std::memory_order_relaxed);
+    }
+}
+
+extern "C" void handle_stream_chunk(std::size_t streamID, int fileIndex, const char* name, double offset, double fileSize, uint8_t* data, int length, int last) {
+    // N.B. offsets/sizes arrive as double (exact up to 2^53) and stay 64-bit: size_t is 32-bit on wasm32 while streamed files may exceed 4 GiB
+    ByteBuffer bytes(std::shared_ptr<const void>(data, [](uint8_t* ptr) { std::free(ptr); }), std::span(data, static_cast<std::size_t>(std::max(length, 0))));
+    auto       state = file::FileIo::instance().findStream(streamID);
+    if (!state) {
+        return; // consumer dropped the stream, 'bytes' releases the chunk
+    }
+    if (!state->tryDeliver(file::FileChunk{.requestID = streamID, .fileIndex = static_cast<std::size_t>(fileIndex), .name = name, .offset = static_cast<std::uint64_t>(offset), .fileSize = static_cast<std::uint64_t>(fileSize), .data = std::move(bytes), .last = last != 0})) {
+        state->finish("stream queue overrun - chunk delivered without room"); // JS checks handle_stream_room() first
+    }
+}
+
+extern "C" void handle_stream_end(std::size_t streamID, const char* error) {
+    if (auto state = file::FileIo::instance().findStream(streamID)) {
+        state->finish(error ? error : "");
+    }
+}
+#endif
@@ -0,0 +1,456 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <format>
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <http_client.hpp>
+
+namespace http {
+
+namespace {
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return std::ranges::equal(a, b, [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+}
+
+std::string toLower(std::string_view text) {
+    std::string lower(text);
+    std::ranges::transform(lower, lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1UZ);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1UZ);
+    }
+    return text;
+}
+} // namespace
+
+std::expected<Url, std::string> Url::parse(std::string_view url) {
+    constexpr std::string_view kScheme = "http://";
+    if (url.size() < kScheme.size() || !equalsIgnoreCase(url.substr(0UZ, kScheme.size()), kScheme)) {
+        return std::unexpected(std::format("unsupported URL (only plain http:// is supported natively): '{}'", url));
+    }
+    url.remove_prefix(kScheme.size());
+    const std::size_t targetStart = url.find_first_of("/?");
+    std::string_view  authority   = url.substr(0UZ, targetStart);
+
+    Url result;
+    result.target = targetStart == std::string_view::npos ? "/" : std::string(url.substr(targetStart));
+    if (result.target.front() == '?') {
+        result.target.insert(0UZ, 1UZ, '/');
+    }
+    if (const auto fragment = result.target.find('#'); fragment != std::string::npos) {
+        result.target.resize(fragment);
+    }
+    if (const auto at = authority.rfind('@'); at != std::string_view::npos) {
+        authority.remove_prefix(at + 1UZ); // user-info is not supported -> ignore
+    }
+    if (const auto colon = authority.rfind(':'); colon != std::string_view::npos && authority.find(']', colon) == std::string_view::npos) {
+        const std::string_view port = authority.substr(colon + 1UZ);
+        if (auto [ptr, ec] = std::from_chars(port.data(), port.data() + port.size(), result.port); ec != std::errc{} || ptr != port.data() + port.size() || result.port == 0U) {
+            return std::unexpected(std::format("invalid port in URL: '{}'", port));
+        }
+        authority = authority.substr(0UZ, colon);
+    }
+    if (authority.size() > 2UZ && authority.front() == '[' && authority.back() == ']') {
+        authority = authority.substr(1UZ, authority.size() - 2UZ); // IPv6 literal
+    }
+    if (authority.empty()) {
+        return std::unexpected("missing host in URL");
+    }
+    result.host = std::string(authority);
+    return result;
+}
+
+std::string_view Response::header(std::string_view lowerCaseName) const noexcept {
+    auto it = std::ranges::find(headers, lowerCaseName, [](const auto& entry) { return std::string_view(entry.first); });
+    return it != headers.end() ? std::string_view(it->second) : std::string_view{};
+}
+
+#if defined(__EMSCRIPTEN__) || defined(_WIN32)
+
+Client::~Client() noexcept = default;
+
+std::expected<Response, std::string> Client::get(std::string_view url, const Headers& /*requestHeaders*/, const std::atomic<bool>* /*cancelled*/) { return std::unexpected(std::format("native HTTP client is not available on this platform: '{}'", url)); }
+
+Client::Statistics Client::statistics() const noexcept { return {0UZ, 0UZ}; }
+
+#else
+
+namespace {
+
+constexpr std::size_t kMaxReserve = 64UZ << 20; // Content-Length/chunk sizes are server-supplied: larger bodies grow as they arrive
+
+/// buffered reader on a blocking socket with SO_RCVTIMEO set
+class SocketReader {
+    int                       _fd;
+    const std::atomic<bool>*  _cancelled; // optional
+    std::chrono::milliseconds _timeout;
+    std::vector<char>         _buffer = std::vector<char>(16UZ * 1024UZ);
+    std::size_t               _begin  = 0UZ;
+    std::size_t               _end    = 0UZ;
+    std::size_t               _total  = 0UZ; // bytes received on this socket by this reader
+
+    // polls in short slices instead of blocking in recv() for up to the read timeout, to notice an abandoned request early
+    bool waitReadable() const {
+        pollfd pfd{.fd = _fd, .events = POLLIN, .revents = 0};
+        for (auto waited = std::chrono::milliseconds(0); waited < _timeout; waited += Client::kCancelPollInterval) {
+            if (_cancelled->load(std::memory_order_acquire)) {
+                return false;
+            }
+            if (const int ready = ::poll(&pfd, 1, static_cast<int>(Client::kCancelPollInterval.count())); ready > 0) {
+                return true; // data, EOF or socket error -> reported by recv()
+            } else if (ready < 0 && errno != EINTR) {
+                return false; // poll() itself failed (e.g. ENOMEM): treated like a read failure
+            }
+        }
+        return false;
+    }
+
+    bool fill() {
+        _begin = 0UZ;
+        _end   = 0UZ;
+        if (_cancelled != nullptr && !waitReadable()) {
+            return false;
+        }
+        const ssize_t n = ::recv(_fd, _buffer.data(), _buffer.size(), 0);
+        _end            = n > 0 ? static_cast<std::size_t>(n) : 0UZ;
+        _total += _end;
+        return n > 0;
+    }
+
+public:
+    SocketReader(int fd, const std::atomic<bool>* cancelled, std::chrono::milliseconds timeout) : _fd(fd), _cancelled(cancelled), _timeout(timeout) {}
+
+    std::size_t received() const noexcept { return _total; }
+
+    /// reads one CRLF-terminated line (without CRLF), false on EOF/error or if the line exceeds 'maxLength'
+    bool readLine(std::string& line, std::size_t maxLength = 64UZ * 1024UZ) {
+        line.clear();
+        while (true) {
+            if (_begin == _end && !fill()) {
+                return false;
+            }
+            const auto first = _buffer.begin() + static_cast<std::ptrdiff_t>(_begin);
+            const auto last  = _buffer.begin() + static_cast<std::ptrdiff_t>(_end);
+            const auto lf    = std::find(first, last, '\n');
+            line.append(first, lf);
+            _begin = static_cast<std::size_t>(lf - _buffer.begin());
+            if (lf != last) {
+                ++_begin;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                return true;
+            }
+            if (line.size() > maxLength) {
+                return false;
+            }
+        }
+    }
+
+    bool readExact(std::size_t count, std::vector<std::uint8_t>& out) {
+        out.reserve(out.size() + std::min(count, kMaxReserve));
+        while (count > 0UZ) {
+            if (_begin == _end && !fill()) {
+                return false;
+            }
+            const std::size_t n = std::min(count, _end - _begin);
+            out.insert(out.end(), _buffer.data() + _begin, _buffer.data() + _begin + n);
+            _begin += n;
+            count -= n;
+        }
+        return true;
+    }
+
+    void readToEnd(std::vector<std::uint8_t>& out) {
+        do {
+            out.insert(out.end(), _buffer.data() + _begin, _buffer.data() + _end);
+            _begin = _end;
+        } while (fill());
+    }
+};
+
+bool sendAll(int fd, std::string_view data) {
+#ifdef MSG_NOSIGNAL
+    constexpr int kFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kFlags = 0;
+#endif
+    while (!data.empty()) {
+        const ssize_t n = ::send(fd, data.data(), data.size(), kFlags);
+        if (n <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+bool waitWritable(int fd, std::chrono::milliseconds timeout) {
+    pollfd pfd{.fd = fd, .events = POLLOUT, .revents = 0};
+    return ::poll(&pfd, 1, static_cast<int>(timeout.count())) == 1 && (pfd.revents & POLLOUT) != 0;
+}
+
+std::string poolKey(const Url& url) { return std::format("{}:{}", url.host, url.port); }
+
+bool isRedirect(int status) { return status == 301 || status == 302 || status == 303 || status == 307 || status == 308; }
+
+} // namespace
+
+Client::~Client() noexcept {
+    std::scoped_lock lock(_poolMutex);
+    for (auto& [key, pool] : _pools) {
+        for (const IdleConnection& connection : pool.idle) {
+            ::close(connection.fd);
+        }
+    }
+}
+
+Client::Statistics Client::statistics() const noexcept {
+    std::scoped_lock lock(_poolMutex);
+    return {_connectionsOpened, _connectionsReused};
+}
+
+std::expected<Response, std::string> Client::get(std::string_view url, const Headers& requestHeaders, const std::atomic<bool>* cancelled) {
+    auto parsed = Url::parse(url);
+    if (!parsed) {
+        return std::unexpected(parsed.error());
+    }
+    for (std::size_t redirect = 0UZ;; ++redirect) {
+        auto response = request(*parsed, requestHeaders, cancelled);
+        if (!response || !isRedirect(response->status) || redirect >= _options.maxRedirects) {
+            return response;
+        }
+        const std::string_view location = response->header("location");
+        if (location.empty()) {
+            return response;
+        }
+        if (location.front() == '/') {
+            parsed->target = std::string(location);
+            continue;
+        }
+        parsed = Url::parse(location);
+        if (!parsed) {
+            return std::unexpected(std::format("redirect to unsupported location: {}", parsed.error()));
+        }
+    }
+}
+
+std::expected<Response, std::string> Client::request(const Url& url, const Headers& requestHeaders, const std::atomic<bool>* cancelled) {
+    auto isCancelled = [cancelled] { return cancelled != nullptr && cancelled->load(std::memory_order_acquire); };
+    std::string message = std::format("GET {} HTTP/1.1\r\nHost: {}\r\nUser-Agent: wasm-threading\r\nAccept: */*\r\nConnection: keep-alive\r\n", url.target, url.authority());
+    for (const auto& [name, value] : requestHeaders) {
+        message += std::format("{}: {}\r\n", name, value);
+    }
+    message += "\r\n";
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        auto fd     = acquire(url, reused);
+        if (!fd) {
+            return std::unexpected(fd.error());
+        }
+
+        SocketReader reader(*fd, cancelled, _options.timeout);
+        std::string  line;
+        if (isCancelled()) {
+            release(url, *fd, true); // nothing sent yet
+            return std::unexpected("cancelled");
+        }
+        if (!sendAll(*fd, message) || !reader.readLine(line)) {
+            release(url, *fd, false);
+            if (isCancelled()) {
+                return std::unexpected("cancelled");
+            }
+            if (reused && reader.received() == 0UZ) {
+                continue; // stale keep-alive connection closed by the server -> retry once on a fresh one
+            }
+            return std::unexpected(std::format("no response from {}", url.authority()));
+        }
+
+        Response response;
+        bool     keepAlive = true;
+        while (true) { // interim 1xx responses (e.g. 100 Continue) precede the final one, each with its own header section
+            // status line: HTTP/1.x SSS reason
+            if (line.size() < 12UZ || !line.starts_with("HTTP/1.") || std::from_chars(line.data() + 9, line.data() + 12, response.status).ec != std::errc{}) {
+                release(url, *fd, false);
+                return std::unexpected(std::format("malformed status line from {}: '{}'", url.authority(), line));
+            }
+            keepAlive = line[7] == '1'; // HTTP/1.1 defaults to keep-alive, HTTP/1.0 to close
+
+            response.headers.clear();
+            while (true) {
+                if (!reader.readLine(line)) {
+                    release(url, *fd, false);
+                    return std::unexpected(isCancelled() ? std::string("cancelled") : std::format("truncated response header from {}", url.authority()));
+                }
+                if (line.empty()) {
+                    break;
+                }
+                if (const auto colon = line.find(':'); colon != std::string::npos) {
+                    response.headers.emplace_back(toLower(std::string_view(line).substr(0UZ, colon)), std::string(trim(std::string_view(line).substr(colon + 1UZ))));
+                }
+            }
+            if (response.status < 100 || response.status >= 200 || response.status == 101) { // 101: final (no upgrade is requested anyway)
+                break;
+            }
+            if (!reader.readLine(line)) {
+                release(url, *fd, false);
+                return std::unexpected(isCancelled() ? std::string("cancelled") : std::format("no final response from {}", url.authority()));
+            }
+        }
+        if (const auto connection = toLower(response.header("connection")); connection == "close") {
+            keepAlive = false;
+        } else if (connection == "keep-alive") {
+            keepAlive = true;
+        }
+
+        bool complete = true;
+        if (toLower(response.header("transfer-encoding")).contains("chunked")) {
+            while (complete) {
+                std::size_t chunkSize = 0UZ;
+                complete              = reader.readLine(line) && std::from_chars(line.data(), line.data() + line.size(), chunkSize, 16).ec == std::errc{};
+                if (!complete || chunkSize == 0UZ) {
+                    break;
+                }
+                complete = reader.readExact(chunkSize, response.body) && reader.readLine(line);
+            }
+            while (complete && reader.readLine(line) && !line.empty()) { // trailer section
+            }
+        } else if (const std::string_view length = response.header("content-length"); !length.empty()) {
+            std::size_t contentLength = 0UZ;
+            complete                  = std::from_chars(length.data(), length.data() + length.size(), contentLength).ec == std::errc{} && reader.readExact(contentLength, response.body);
+        } else if (response.status == 204 || response.status == 304 || (response.status >= 100 && response.status < 200)) {
+            // no body
+        } else {
+            reader.readToEnd(response.body); // close-delimited
+            keepAlive = false;
+        }
+
+        release(url, *fd, complete && keepAlive); // N.B. an aborted transfer closes the connection: the rest is never downloaded
+        if (!complete || isCancelled()) {
+            return std::unexpected(isCancelled() ? std::string("cancelled") : std::format("truncated response body from {}", url.authority()));
+        }
+        return response;
+    }
+    return std::unexpected(std::format("connection to {} closed by peer", url.authority()));
+}
+
+std::expected<int, std::string> Client::acquire(const Url& url, bool& reused) {
+    const auto       now = std::chrono::steady_clock::now();
+    std::unique_lock lock(_poolMutex);
+    HostPool&        pool = _pools[poolKey(url)];
+    _connectionReleased.wait(lock, [&] { return !pool.idle.empty() || pool.inUse < _options.maxConnectionsPerHost; });
+
+    while (!pool.idle.empty()) {
+        IdleConnection connection = pool.idle.back();
+        pool.idle.pop_back();
+        if (now - connection.lastUsed < _options.idleTimeout) {
+            ++pool.inUse;
+            ++_connectionsReused;
+            reused = true;
+            return connection.fd;
+        }
+        ::close(connection.fd); // probably closed by the server already
+    }
+    ++pool.inUse;
+    lock.unlock();
+
+    auto fd = connectTo(url);
+    lock.lock();
+    if (!fd) {
+        --pool.inUse;
+        _connectionReleased.notify_one();
+        return fd;
+    }
+    ++_connectionsOpened;
+    reused = false;
+    return fd;
+}
+
+void Client::release(const Url& url, int fd, bool keepAlive) {
+    {
+        std::scoped_lock lock(_poolMutex);
+        HostPool&        pool = _pools[poolKey(url)];
+        --pool.inUse;
+        if (keepAlive) {
+            pool.idle.push_back({fd, std::chrono::steady_clock::now()});
+        } else {
+            ::close(fd);
+        }
+    }
+    _connectionReleased.notify_one();
+}
+
+std::expected<int, std::string> Client::connectTo(const Url& url) const {
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo*         addresses = nullptr;
+    const std::string port      = std::to_string(url.port);
+    if (const int rc = ::getaddrinfo(url.host.c_str(), port.c_str(), &hints, &addresses); rc != 0) {
+        return std::unexpected(std::format("could not resolve '{}': {}", url.host, ::gai_strerror(rc)));
+    }
+
+    std::string lastError = "no address";
+    for (const addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        const int fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) {
+            lastError = std::strerror(errno);
+            continue;
+        }
+        // non-blocking connect to honour the timeout, then back to blocking I/O with send/receive timeouts
+        const int flags = ::fcntl(fd, F_GETFL, 0);
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int  error     = 0;
+        bool connected = ::connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+        if (!connected && errno == EINPROGRESS && waitWritable(fd, _options.timeout)) {
+            socklen_t length = sizeof(error);
+            connected        = ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+        }
+        if (!connected) {
+            lastError = error != 0 ? std::strerror(error) : std::strerror(errno == EINPROGRESS ? ETIMEDOUT : errno);
+            ::close(fd);
+            continue;
+        }
+        ::fcntl(fd, F_SETFL, flags);
+
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(_options.timeout);
+        const auto micros  = std::chrono::duration_cast<std::chrono::microseconds>(_options.timeout - seconds);
+        const timeval timeout{.tv_sec = static_cast<time_t>(seconds.count()), .tv_usec = static_cast<suseconds_t>(micros.count())};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        const int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+        const int noSigPipe = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+        ::freeaddrinfo(addresses);
+        return fd;
+    }
+    ::freeaddrinfo(addresses);
+    return std::unexpected(std::format("could not connect to {}: {}", url.authority(), lastError));
+}
+
+#endif
+
+} // namespace http
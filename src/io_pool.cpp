@@ -0,0 +1,402 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <print>
+#include <system_error>
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include <io_pool.hpp>
+
+namespace file {
+
+// single sized read (instead of a per-character istreambuf_iterator loop into a growing vector)
+ReadResult readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return std::unexpected(std::format("could not open '{}'", path));
+    }
+    const std::streamsize size = in.tellg();
+    if (size < 0) {
+        return std::unexpected(std::format("could not determine size of '{}'", path));
+    }
+    std::vector<std::uint8_t> data(static_cast<std::size_t>(size));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(data.data()), size)) {
+        return std::unexpected(std::format("could not read '{}' ({} of {} bytes)", path, in.gcount(), size));
+    }
+    return ByteBuffer(std::move(data));
+}
+
+// read-only private mapping of files of at least 'minSize' bytes (smaller ones and unsupported platforms use readFile()),
+// the pages are faulted in lazily (or all upfront if 'prefault') and unmapped together with the last ByteBuffer referring to them
+ReadResult mapFile(const std::string& path, [[maybe_unused]] std::size_t minSize, [[maybe_unused]] bool prefault) {
+#if defined(__EMSCRIPTEN__) || defined(_WIN32)
+    return readFile(path);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(std::format("could not open '{}': {}", path, std::strerror(errno)));
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || static_cast<std::size_t>(status.st_size) < std::max(minSize, 1UZ)) {
+        ::close(fd);
+        return readFile(path); // empty, special or small file
+    }
+    const auto size  = static_cast<std::size_t>(status.st_size);
+    int        flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    flags |= prefault ? MAP_POPULATE : 0; // reads the whole file before mmap() returns
+#endif
+    void* address = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (address == MAP_FAILED) {
+        return readFile(path);
+    }
+    if (prefault) { // the disk I/O happens here (on the I/O thread) instead of on the consumer's first access
+        ::madvise(address, size, MADV_WILLNEED);
+#ifndef MAP_POPULATE
+        const auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        for (std::size_t offset = 0UZ; offset < size; offset += pageSize) {
+            (void)*static_cast<const volatile std::uint8_t*>(static_cast<std::uint8_t*>(address) + offset);
+        }
+#endif
+    } else {
+        ::madvise(address, size, MADV_SEQUENTIAL); // hint only: aggressive read-ahead, early reclaim behind the reader
+    }
+
+    std::shared_ptr<const void> mapping(address, [size](const void* ptr) { ::munmap(const_cast<void*>(ptr), size); });
+    return ByteBuffer(std::move(mapping), std::span(static_cast<const std::uint8_t*>(address), size));
+#endif
+}
+
+ReadResult readFileRange(const std::string& path, ByteRange range) {
+#if defined(__EMSCRIPTEN__) || defined(_WIN32)
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return std::unexpected(std::format("could not open '{}'", path));
+    }
+    const std::streamsize size = in.tellg();
+    if (size < 0) {
+        return std::unexpected(std::format("could not determine size of '{}'", path));
+    }
+    const auto [offset, count] = range.clampTo(static_cast<std::uint64_t>(size));
+    std::vector<std::uint8_t> data(count);
+    in.seekg(static_cast<std::streamoff>(offset));
+    if (!in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(count))) {
+        return std::unexpected(std::format("could not read '{}' ({} of {} bytes at offset {})", path, in.gcount(), count, offset));
+    }
+    return ByteBuffer(std::move(data));
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(std::format("could not open '{}': {}", path, std::strerror(errno)));
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        return std::unexpected(std::format("could not determine size of '{}': {}", path, std::strerror(errno)));
+    }
+    const auto [offset, count] = range.clampTo(static_cast<std::uint64_t>(status.st_size));
+    std::vector<std::uint8_t> data(count);
+    for (std::size_t done = 0UZ; done < count;) {
+        const ssize_t n = ::pread(fd, data.data() + done, count - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            const std::string error = n < 0 ? std::strerror(errno) : "unexpected end of file";
+            ::close(fd);
+            return std::unexpected(std::format("could not read '{}' ({} of {} bytes at offset {}): {}", path, done, count, offset, error));
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    ::close(fd);
+    return ByteBuffer(std::move(data));
+#endif
+}
+
+ReadResult loadLocalFile(const std::string& path, LoadMode mode, ByteRange range) {
+    if (!range.whole()) {
+        if (mode != LoadMode::Map) {
+            return readFileRange(path, range); // windows are typically small
+        }
+        auto whole = mapFile(path, 0UZ); // only the window's pages are faulted in
+        if (!whole) {
+            return whole;
+        }
+        const auto [offset, count] = range.clampTo(whole->size());
+        return whole->slice(offset, count);
+    }
+    switch (mode) {
+    case LoadMode::Read: return readFile(path);
+    case LoadMode::Map: return mapFile(path, 0UZ);
+    case LoadMode::Auto:
+    default: return mapFile(path, kMapThreshold, true);
+    }
+}
+
+namespace {
+// loads on the I/O threads must complete even if they throw, e.g. bad_alloc for a huge file
+ReadResult tryLoadLocalFile(const std::string& path, LoadMode mode, ByteRange range) noexcept {
+    try {
+        return loadLocalFile(path, mode, range);
+    } catch (const std::exception& e) {
+        return std::unexpected(std::format("could not load '{}': {}", path, e.what()));
+    }
+}
+} // namespace
+
+#ifdef HAVE_LIBURING
+struct IoPool::Ring {
+    io_uring ring;
+
+    // one file in flight: blocks are read straight into 'data' which becomes the FileData storage
+    struct File {
+        Job                       job;
+        int                       fd = -1;
+        std::vector<std::uint8_t> data;
+        std::uint64_t             base      = 0U;  // file offset of data[0] (ranged loads)
+        std::size_t               submitted = 0UZ; // bytes handed to the kernel
+        std::size_t               completed = 0UZ; // bytes read
+        std::size_t               inFlight  = 0UZ; // outstanding block reads
+        std::string               error;
+    };
+    struct Block {
+        File*       file;
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    explicit Ring(unsigned entries) {
+        if (const int rc = io_uring_queue_init(entries, &ring, 0); rc < 0) {
+            throw std::system_error(-rc, std::generic_category(), "io_uring_queue_init");
+        }
+    }
+    ~Ring() noexcept { io_uring_queue_exit(&ring); }
+
+    bool submitRead(File& file, std::size_t offset, std::size_t length) {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (sqe == nullptr) {
+            return false;
+        }
+        io_uring_prep_read(sqe, file.fd, file.data.data() + offset, static_cast<unsigned>(length), file.base + offset);
+        io_uring_sqe_set_data(sqe, new Block{&file, offset, length});
+        ++file.inFlight;
+        return true;
+    }
+};
+#else
+struct IoPool::Ring {};
+#endif
+
+IoPool::IoPool(std::size_t queueDepth) : _queueDepth(std::clamp(queueDepth, 1UZ, kMaxQueueDepth)) {
+#ifdef HAVE_LIBURING
+    try {
+        _ring = std::make_unique<Ring>(static_cast<unsigned>(kMaxQueueDepth));
+        _workers.emplace_back(&IoPool::runRing, this);
+        return;
+    } catch (const std::exception& e) { // e.g. old kernel or io_uring disabled by seccomp/sysctl
+        std::println(stderr, "[IoPool] io_uring unavailable ({}) - using the thread-pool backend", e.what());
+        _ring.reset();
+    }
+#endif
+    setQueueDepth(queueDepth);
+}
+
+IoPool::~IoPool() noexcept {
+    {
+        std::scoped_lock lock(_mutex);
+        _stopping = true;
+    }
+    _jobAvailable.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void IoPool::submit(std::string path, LoadMode mode, Completion onDone, CancelFlag cancelled, ByteRange range) {
+    {
+        std::scoped_lock lock(_mutex);
+        _jobs.push_back(Job{std::move(path), mode, std::move(onDone), std::move(cancelled), range});
+    }
+    _jobAvailable.notify_one();
+}
+
+void IoPool::setQueueDepth(std::size_t depth) {
+    depth = std::clamp(depth, 1UZ, kMaxQueueDepth);
+    _queueDepth.store(depth, std::memory_order_relaxed);
+    if (usesIoUring()) {
+        return; // ring entries are pre-allocated for kMaxQueueDepth
+    }
+    std::scoped_lock lock(_mutex);
+    while (_workers.size() < depth) { // grow only, surplus workers idle since at most 'depth' loads are admitted
+        _workers.emplace_back(&IoPool::runWorker, this);
+    }
+    _jobAvailable.notify_all();
+}
+
+void IoPool::runWorker() {
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _jobAvailable.wait(lock, [this] { return _stopping || (!_jobs.empty() && _active < queueDepth()); });
+        if (_jobs.empty()) {
+            return; // stopping and drained
+        }
+        Job job = std::move(_jobs.front());
+        _jobs.pop_front();
+        ++_active;
+        lock.unlock();
+
+        job.onDone(isCancelled(job.cancelled) ? ReadResult(std::unexpected("cancelled")) : tryLoadLocalFile(job.path, job.mode, job.range));
+
+        lock.lock();
+        --_active;
+        _jobAvailable.notify_one();
+    }
+}
+
+#ifdef HAVE_LIBURING
+void IoPool::runRing() {
+    using File = Ring::File;
+    std::vector<std::unique_ptr<File>> files; // admitted, not yet completed
+    std::size_t                        inFlight = 0UZ;
+
+    // Map only sets up a mapping and completes right away, everything else is read through the ring (N.B. incl. large Auto files:
+    // prefaulting a mapping would stall this single thread and with it the reads of all other files in flight)
+    auto admit = [&files](Job&& job) {
+        if (isCancelled(job.cancelled)) {
+            job.onDone(std::unexpected("cancelled"));
+            return;
+        }
+        if (job.mode == LoadMode::Map) {
+            job.onDone(tryLoadLocalFile(job.path, LoadMode::Map, job.range));
+            return;
+        }
+        auto file = std::make_unique<File>(File{.job = std::move(job)});
+        file->fd  = ::open(file->job.path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status{};
+        if (file->fd < 0 || ::fstat(file->fd, &status) != 0) {
+            file->job.onDone(std::unexpected(std::format("could not open '{}': {}", file->job.path, std::strerror(errno))));
+            if (file->fd >= 0) {
+                ::close(file->fd);
+            }
+            return;
+        }
+        const auto [offset, count] = file->job.range.clampTo(static_cast<std::uint64_t>(status.st_size));
+        file->base                 = offset;
+        try {
+            file->data.resize(count);
+        } catch (const std::exception& e) {
+            ::close(file->fd);
+            file->job.onDone(std::unexpected(std::format("could not load '{}': {}", file->job.path, e.what())));
+            return;
+        }
+        files.push_back(std::move(file));
+    };
+
+    auto complete = [](File& file) {
+        ::close(file.fd);
+        if (file.error.empty()) {
+            file.job.onDone(ByteBuffer(std::move(file.data)));
+        } else {
+            file.job.onDone(std::unexpected(std::move(file.error)));
+        }
+    };
+
+    while (true) {
+        // admit new jobs: blocking only if there is nothing in flight
+        {
+            std::unique_lock lock(_mutex);
+            if (inFlight == 0UZ && files.empty()) {
+                _jobAvailable.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+                if (_jobs.empty()) {
+                    return; // stopping and drained
+                }
+            }
+            while (!_jobs.empty() && files.size() < queueDepth()) {
+                Job job = std::move(_jobs.front());
+                _jobs.pop_front();
+                lock.unlock();
+                admit(std::move(job));
+                lock.lock();
+            }
+        }
+
+        // abandoned files stop submitting blocks and complete (releasing their buffer) once their in-flight reads returned
+        for (auto& file : files) {
+            if (file->error.empty() && isCancelled(file->job.cancelled)) {
+                file->error = "cancelled";
+            }
+        }
+
+        // top up block reads round-robin over the admitted files until the queue depth is reached
+        for (bool progress = true; progress && inFlight < queueDepth();) {
+            progress = false;
+            for (auto& file : files) {
+                if (inFlight < queueDepth() && file->error.empty() && file->submitted < file->data.size()) {
+                    const std::size_t length = std::min(kBlockSize, file->data.size() - file->submitted);
+                    if (!_ring->submitRead(*file, file->submitted, length)) {
+                        break; // submission queue full
+                    }
+                    file->submitted += length;
+                    ++inFlight;
+                    progress = true;
+                }
+            }
+        }
+
+        io_uring_cqe* cqe = nullptr;
+        if (inFlight > 0UZ && io_uring_submit_and_wait(&_ring->ring, 1) >= 0) {
+            unsigned head  = 0U;
+            unsigned count = 0U;
+            io_uring_for_each_cqe(&_ring->ring, head, cqe) {
+                std::unique_ptr<Ring::Block> block(static_cast<Ring::Block*>(io_uring_cqe_get_data(cqe)));
+                File&                        file = *block->file;
+                --file.inFlight;
+                --inFlight;
+                ++count;
+                if (cqe->res < 0) {
+                    file.error = std::format("read error in '{}' at offset {}: {}", file.job.path, file.base + block->offset, std::strerror(-cqe->res));
+                } else if (cqe->res == 0) {
+                    file.error = std::format("unexpected end of '{}' at offset {} (file truncated while reading?)", file.job.path, file.base + block->offset);
+                } else if (static_cast<std::size_t>(cqe->res) < block->length) { // short read -> resubmit the remainder
+                    file.completed += static_cast<std::size_t>(cqe->res);
+                    if (_ring->submitRead(file, block->offset + static_cast<std::size_t>(cqe->res), block->length - static_cast<std::size_t>(cqe->res))) {
+                        ++inFlight;
+                    } else {
+                        file.error = "io_uring submission queue full";
+                    }
+                } else {
+                    file.completed += block->length;
+                }
+            }
+            io_uring_cq_advance(&_ring->ring, count);
+        }
+
+        // hand finished (or failed and quiesced) files to their completions
+        std::erase_if(files, [&](const std::unique_ptr<File>& file) {
+            const bool finished = file->inFlight == 0UZ && (!file->error.empty() || file->completed == file->data.size());
+            if (finished) {
+                complete(*file);
+            }
+            return finished;
+        });
+    }
+}
+#else
+void IoPool::runRing() {}
+#endif
+
+} // namespace file
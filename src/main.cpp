@@ -15,9 +15,12 @@
 
 #include <Clipboard.hpp>
 #include <EmscriptenHelper.hpp>
+#include <LockFreeQueue.hpp>
+#include <Scheduler.hpp>
 #include <audio.hpp>
 #include <audio_sdl.hpp>
 #include <file_io.hpp>
+#include <zip_writer.hpp>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -28,9 +31,9 @@ SDL_Window*       g_Window    = nullptr;
 SDL_GLContext     g_GLContext = nullptr;
 std::atomic<bool> g_Running{true};
 
-std::atomic<bool> g_BackgroundTaskRunning{false};
-std::atomic<bool> g_TriggerTask{false};
-std::thread       g_BackgroundThread;
+std::atomic<bool>                                               g_BackgroundTaskRunning{false};
+LockFreeQueue<std::size_t, 8UZ, QueueLayout::CacheLineIsolated> g_TaskQueue; // UI thread -> background thread
+std::thread                                                     g_BackgroundThread;
 
 AudioPlayer    g_Audio;
 static bool    g_AudioStarted = false;
@@ -39,40 +42,49 @@ static bool    g_AudioStarted_sdl = false;
 
 static std::optional<file::FileData> g_Uploaded;
 
-bool duplicateUploadedFile(const std::string& baseName, const std::vector<uint8_t>& data, int count = 5) {
+// bundles all duplicates into one archive (a single download on WASM instead of one per copy)
+bool duplicateUploadedFile(const std::string& baseName, const ByteBuffer& data, int count = 5) {
     if (data.empty()) {
         std::println("[FileIO] No data to duplicate.");
         return false;
     }
-    bool ok = true;
+    file::ZipWriter archive(std::format("{}_duplicates.zip", baseName));
+    bool            ok = true;
     for (int i = 0; i < count; ++i) {
         std::string dupName = std::format("{}_{}", baseName, i);
-        try {
-            file::FileIo::instance().writeFile(dupName, data);
+        if (auto added = archive.add(dupName, data); added) {
             std::println("[FileIO] Duplicate created: {}", dupName);
-        } catch (const std::exception& e) {
-            std::println("[FileIO] Write failed: {}", e.what());
+        } else {
+            std::println("[FileIO] Write failed: {}", added.error());
             ok = false;
         }
     }
+    if (auto finished = archive.finish(); !finished) {
+        std::println("[FileIO] Write failed: {}", finished.error());
+        ok = false;
+    }
     return ok;
 }
 
 void backgroundProcessingLoop() {
     std::println("[Background] Started backgroundProcessingLoop() - WASM main thread: {}", isMainThread());
     while (g_Running.load()) {
-        if (g_TriggerTask.exchange(false)) {
+        // parks until the UI thread submits a task, the timeout only bounds the shutdown latency
+        if (auto task = g_TaskQueue.pop_front_wait(std::chrono::milliseconds(250)); task) {
             g_BackgroundTaskRunning.store(true);
-            std::println("[Background] Started long task");
-            for (int i = 0; i < 5; ++i) {
-                std::string fileName = std::format("test_file_{}.txt", i);
-                file::FileIo::instance().writeFile(fileName, {'H', 'e', 'l', 'l', 'o'});
+            std::println("[Background] Started long task #{}", *task);
+            {
+                file::ZipWriter                 archive(std::format("test_files_{}.zip", *task)); // one download for the whole batch
+                const std::vector<std::uint8_t> content{'H', 'e', 'l', 'l', 'o'};
+                for (int i = 0; i < 5; ++i) {
+                    if (auto added = archive.add(std::format("test_file_{}.txt", i), content); !added) {
+                        std::println(stderr, "[Background] {}", added.error());
+                    }
+                }
             }
             std::this_thread::sleep_for(std::chrono::seconds(3));
             std::println("[Background] Finished long task");
             g_BackgroundTaskRunning.store(false);
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
     }
 }
@@ -86,7 +98,8 @@ void renderFrame() {
         }
     }
 
-    file::FileIo::instance().processPendingWrites();
+    file::FileIo::instance().processPendingWrites(std::chrono::microseconds(2000)); // ~1/8 of a 60 Hz frame, the rest follows in later frames
+    Scheduler::instance().runMainThreadTasks(); // Request::then(..)/co_await continuations targeting the main thread
     if (auto newUploads = file::FileIo::instance().pollUploadedFile(); !newUploads.empty()) {
         for (auto& newFile : newUploads) {
             g_Uploaded = std::move(newFile);
@@ -99,8 +112,9 @@ void renderFrame() {
     ImGui::NewFrame();
 
     ImGui::Begin("Tasks & FileIO", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+    static std::size_t taskCounter = 0UZ;
     if (ImGui::Button("Run Long Task") && !g_BackgroundTaskRunning.load()) {
-        g_TriggerTask = true;
+        g_TaskQueue.push_back(taskCounter++);
     }
     ImGui::SameLine();
     ImGui::Text(g_BackgroundTaskRunning ? "Background task is running..." : "Idle.");
@@ -134,7 +148,7 @@ void renderFrame() {
         uploadRequest = file::FileIo::instance().loadFile();
     }
     ImGui::SameLine();
-    if (uploadRequest.isOwner() && uploadRequest.get().has_value()) { // demo for async behaviour
+    if (uploadRequest.ready() && uploadRequest.get().has_value()) { // demo for async behaviour
         ImGui::Text("Uploaded %zu files - first: %s (%zu bytes)", uploadRequest.get().value().size(), uploadRequest.get().value()[0].name.c_str(), uploadRequest.get().value()[0].data.size());
     } else {
         ImGui::Text("No uploaded file yet.");
@@ -149,10 +163,10 @@ void renderFrame() {
 
         // normally only used in non-WASM apps:
         // urlRequest1.wait(); // wait indefinitely
-        // urlRequest1.wait(std::chrono::milliseconds(100)); // wait with time-out
+        // urlRequest1.wait_for(std::chrono::milliseconds(100)); // wait with time-out
     }
     ImGui::SameLine();
-    if (urlRequest1.isOwner() && urlRequest1.get().has_value()) { // demo for async behaviour
+    if (urlRequest1.ready() && urlRequest1.get().has_value()) { // demo for async behaviour
         ImGui::Text("Uploaded URL: %s (%zu bytes)", urlRequest1.get().value()[0].name.c_str(), urlRequest1.get().value()[0].data.size());
     } else {
         ImGui::Text("No URL file uploaded.");
@@ -164,13 +178,13 @@ void renderFrame() {
             urlRequest2 = file::FileIo::instance().loadFile("https://upload.wikimedia.org/wikipedia/commons/thumb/5/54/FAIR_Logo_rgb.png/330px-FAIR_Logo_rgb.png");
         });
         run.detach();
-        if (urlRequest2.wait()) {
+        if (urlRequest2.wait_for(std::chrono::milliseconds(100))) {
             std::println("[Main] Waiting for request received:\n{}",
-                (urlRequest2.isOwner() && urlRequest2.get().has_value())? urlRequest2.get().value()[0].name.c_str() : " nothing");
+                (urlRequest2.ready() && urlRequest2.get().has_value())? urlRequest2.get().value()[0].name.c_str() : " nothing");
         }
     }
     ImGui::SameLine();
-    if (urlRequest2.isOwner() && urlRequest2.get().has_value()) { // demo for async behaviour
+    if (urlRequest2.ready() && urlRequest2.get().has_value()) { // demo for async behaviour
         ImGui::Text("Uploaded URL: %s (%zu bytes)", urlRequest2.get().value()[0].name.c_str(), urlRequest2.get().value()[0].data.size());
     } else {
         ImGui::Text("No URL file uploaded.");
@@ -181,11 +195,21 @@ void renderFrame() {
         uploadPath = file::FileIo::instance().loadFile("assets/audio/sample2.ogg");
     }
     ImGui::SameLine();
-    if (uploadPath.isOwner() && uploadPath.get().has_value()) { // demo for async behaviour
+    if (uploadPath.ready() && uploadPath.get().has_value()) { // demo for async behaviour
         ImGui::Text("Uploaded path: %s (%zu bytes)", uploadPath.get().value()[0].name.c_str(), uploadPath.get().value()[0].data.size());
     } else {
         ImGui::Text("No file from path (yet).");
     }
+    const auto assets = file::FileIo::instance().assetCacheStatistics(); // tune setAssetCacheBudget() against the WASM heap limit
+    ImGui::Text("Asset cache: %zu entries, %zu of %zu bytes (peak %zu), %zu hits, %zu misses, %zu joined in-flight, %zu evicted", assets.cache.entries, assets.cache.cost, assets.cache.budget, assets.cache.peakCost, assets.cache.hits, assets.cache.misses, assets.coalesced, assets.cache.evictions);
+    const auto blobs = file::FileIo::instance().blobStoreStatistics(); // memory won by sharing identical uploads
+    ImGui::Text("Blob store: %zu blobs (%llu bytes), %zu of %zu payloads deduplicated, %llu bytes saved (ratio %.2f)", blobs.blobs, static_cast<unsigned long long>(blobs.bytes), blobs.deduplicated, blobs.interned, static_cast<unsigned long long>(blobs.bytesSaved), blobs.dedupRatio);
+    const auto drain = file::FileIo::instance().writeDrainStatistics();
+    ImGui::Text("Pending writes: %zu queued (peak %zu), last frame %zu in %lld us (max %lld us), %zu frames over budget", drain.backlog, drain.peakBacklog, drain.lastDrained, static_cast<long long>(drain.lastDrainTime.count()), static_cast<long long>(drain.maxDrainTime.count()), drain.deferred);
+#ifndef __EMSCRIPTEN__
+    const auto writes = file::FileIo::instance().writeStatistics();
+    ImGui::Text("Writes: %zu files (%zu coalesced, %zu failed, %zu pending), latency mean %.2f ms / max %.2f ms, %.1f MB/s", writes.writes, writes.coalesced, writes.failed, writes.pending, static_cast<double>(writes.meanLatency.count()) * 1e-6, static_cast<double>(writes.maxLatency.count()) * 1e-6, writes.bytesPerSecond * 1e-6);
+#endif
 
     if (g_Uploaded) {
         ImGui::Text("Uploaded: %s (%zu bytes)", g_Uploaded->name.c_str(), g_Uploaded->data.size());
@@ -327,6 +351,8 @@ int main() {
         return 1;
     }
 
+    file::FileIo::instance().enableUrlCache(); // repeated URL loads (also across sessions) are served from the persistent cache
+    file::FileIo::instance().enableDecompression(); // '.gz'/'.zst' assets arrive inflated, decoded off the main thread
     g_BackgroundThread = std::thread(backgroundProcessingLoop);
 
 #ifdef __EMSCRIPTEN__
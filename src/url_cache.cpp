@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <print>
+#include <vector>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+#include <io_pool.hpp>
+#include <url_cache.hpp>
+
+namespace file {
+
+namespace {
+constexpr std::string_view kMetaMagic = "wasm-threading-url-cache 2"; // 2: per-entry lifetime
+
+std::uint64_t fnv1a(std::string_view text) noexcept {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c : text) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::int64_t secondsSinceEpoch() noexcept { return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count(); }
+
+bool equalsIgnoreCase(std::string_view text, std::string_view lowerCase) noexcept {
+    return std::ranges::equal(text, lowerCase, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+}
+
+std::string_view trim(std::string_view text) noexcept {
+    const std::size_t first = text.find_first_not_of(" \t");
+    return first == std::string_view::npos ? std::string_view{} : text.substr(first, text.find_last_not_of(" \t") - first + 1UZ);
+}
+
+// Cache-Control directives ('name' or 'name=value', comma-separated) -> fn(name, unquoted value)
+template<typename Fn>
+void forEachDirective(std::string_view cacheControl, Fn&& fn) {
+    while (!cacheControl.empty()) {
+        const std::size_t comma     = std::min(cacheControl.find(','), cacheControl.size());
+        const auto        directive = cacheControl.substr(0UZ, comma);
+        cacheControl.remove_prefix(std::min(comma + 1UZ, cacheControl.size()));
+        const std::size_t equals = directive.find('=');
+        std::string_view  value  = equals == std::string_view::npos ? std::string_view{} : trim(directive.substr(equals + 1UZ));
+        if (value.size() >= 2UZ && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1UZ, value.size() - 2UZ);
+        }
+        fn(trim(directive.substr(0UZ, equals)), value);
+    }
+}
+
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT" (the only format senders may generate, RFC 9110 5.6.7)
+std::optional<std::int64_t> parseHttpDate(std::string_view date) {
+    constexpr std::array<std::string_view, 12UZ> kMonths{"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    date = trim(date);
+    if (date.size() != 29UZ || date.substr(3UZ, 2UZ) != ", " || date.substr(25UZ) != " GMT") {
+        return std::nullopt;
+    }
+    auto number = [&](std::size_t offset, std::size_t length) -> std::optional<int> {
+        int value = 0;
+        for (const char c : date.substr(offset, length)) {
+            if (c < '0' || c > '9') {
+                return std::nullopt;
+            }
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    };
+    const auto month = std::ranges::find(kMonths, date.substr(8UZ, 3UZ));
+    const auto day = number(5UZ, 2UZ), year = number(12UZ, 4UZ), hours = number(17UZ, 2UZ), minutes = number(20UZ, 2UZ), seconds = number(23UZ, 2UZ);
+    if (month == kMonths.end() || !day || !year || !hours || !minutes || !seconds) {
+        return std::nullopt;
+    }
+    const std::chrono::year_month_day ymd{std::chrono::year(*year), std::chrono::month(static_cast<unsigned>(month - kMonths.begin()) + 1U), std::chrono::day(static_cast<unsigned>(*day))};
+    if (!ymd.ok()) {
+        return std::nullopt;
+    }
+    return std::chrono::sys_days(ymd).time_since_epoch().count() * 86400LL + *hours * 3600LL + *minutes * 60LL + *seconds;
+}
+
+std::filesystem::path defaultDirectory() {
+#ifdef __EMSCRIPTEN__
+    return "/cache/url";
+#else
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && *xdg != '\0') {
+        return std::filesystem::path(xdg) / "wasm-threading" / "url";
+    }
+    if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+        return std::filesystem::path(home) / ".cache" / "wasm-threading" / "url";
+    }
+    std::error_code ec;
+    return std::filesystem::temp_directory_path(ec) / "wasm-threading-url-cache";
+#endif
+}
+
+// write-then-rename: readers (and memory mappings of the previous body) never observe a partially written file
+bool writeAtomically(const std::filesystem::path& path, std::span<const std::uint8_t> bytes) {
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    return !ec;
+}
+} // namespace
+
+UrlCache::UrlCache(Options options) : _options(std::move(options)) {
+    if (_options.directory.empty()) {
+        _options.directory = defaultDirectory();
+    }
+#ifdef __EMSCRIPTEN__
+    // IDBFS keeps the directory in IndexedDB: restore it asynchronously, handle_url_cache_loaded() then re-reads the index
+    MAIN_THREAD_EM_ASM(
+        {
+            const directory = UTF8ToString($0);
+            try {
+                FS.mkdirTree(directory);
+                FS.mount(IDBFS, {}, directory);
+            } catch (e) {
+                console.error("[UrlCache] could not mount IDBFS at " + directory + ": ", e);
+                return;
+            }
+            FS.syncfs(true, (error) => {
+                if (error) {
+                    console.error("[UrlCache] could not restore " + directory + ": ", error);
+                }
+                Module.ccall('handle_url_cache_loaded', null, [], []);
+            });
+        },
+        _options.directory.c_str());
+#else
+    std::error_code ec;
+    std::filesystem::create_directories(_options.directory, ec);
+    if (ec) {
+        std::println(stderr, "[UrlCache] could not create '{}': {}", _options.directory.string(), ec.message());
+    }
+    reload();
+#endif
+}
+
+std::filesystem::path UrlCache::pathOf(std::string_view url, std::string_view extension) const { return _options.directory / std::format("{:016x}{}", fnv1a(url), extension); }
+
+bool UrlCache::writeMeta(std::string_view url, const Record& record) const {
+    const std::string meta = std::format("{}\n{}\n{}\n{}\n{}\n{}\n{}\n", kMetaMagic, url, record.etag, record.lastModified, record.storedAt, record.lifetime, record.size);
+    return writeAtomically(pathOf(url, ".meta"), std::span(reinterpret_cast<const std::uint8_t*>(meta.data()), meta.size()));
+}
+
+void UrlCache::reload() {
+    struct Found {
+        std::string                     url;
+        Record                          record;
+        std::filesystem::file_time_type lastUsed;
+    };
+    std::vector<Found> found;
+    std::error_code    ec;
+    for (const auto& file : std::filesystem::directory_iterator(_options.directory, ec)) {
+        if (file.path().extension() != ".meta") {
+            continue;
+        }
+        std::ifstream in(file.path());
+        std::string   magic;
+        Found         entry{};
+        std::string   storedAt;
+        std::string   lifetime;
+        std::string   size;
+        if (!std::getline(in, magic) || magic != kMetaMagic || !std::getline(in, entry.url) || !std::getline(in, entry.record.etag) || !std::getline(in, entry.record.lastModified) || !std::getline(in, storedAt) || !std::getline(in, lifetime) || !std::getline(in, size)) {
+            continue; // foreign, older version or truncated -> overwritten by the next store() of the URL
+        }
+        std::error_code sizeError;
+        entry.record.storedAt = std::strtoll(storedAt.c_str(), nullptr, 10);
+        entry.record.lifetime = std::strtoll(lifetime.c_str(), nullptr, 10);
+        entry.record.size     = std::strtoull(size.c_str(), nullptr, 10);
+        if (std::filesystem::file_size(pathOf(entry.url, ".bin"), sizeError) != entry.record.size || sizeError) {
+            continue;
+        }
+        entry.lastUsed = std::filesystem::last_write_time(file.path(), sizeError); // lookups touch the meta file
+        found.push_back(std::move(entry));
+    }
+    std::ranges::sort(found, {}, &Found::lastUsed);
+
+    std::scoped_lock lock(_mutex);
+    _index.clear();
+    _bytes = 0U;
+    for (Found& entry : found) {
+        entry.record.lastUsed = ++_clock;
+        _bytes += entry.record.size;
+        _index.insert_or_assign(std::move(entry.url), std::move(entry.record));
+    }
+    evict();
+}
+
+std::optional<UrlCache::Entry> UrlCache::lookup(std::string_view url) {
+    const std::string key(url);
+    Record            record;
+    {
+        std::scoped_lock lock(_mutex);
+        auto             it = _index.find(key);
+        if (it == _index.end()) {
+            ++_statistics.misses;
+            return std::nullopt;
+        }
+        record = it->second;
+    }
+    auto data = loadLocalFile(pathOf(url, ".bin").string(), LoadMode::Auto); // N.B. not under '_mutex': reads (or maps) the whole body
+    std::error_code ec;
+    std::filesystem::last_write_time(pathOf(url, ".meta"), std::filesystem::file_time_type::clock::now(), ec); // LRU order across sessions
+
+    std::scoped_lock lock(_mutex);
+    auto             it = _index.find(key);
+    if (it == _index.end() || it->second.storedAt != record.storedAt || it->second.size != record.size) { // stored or erased meanwhile
+        ++_statistics.misses;
+        return std::nullopt;
+    }
+    if (!data || data->size() != record.size) { // removed or replaced behind our back
+        erase(key);
+        ++_statistics.misses;
+        return std::nullopt;
+    }
+    it->second.lastUsed = ++_clock;
+
+    const bool fresh = secondsSinceEpoch() - it->second.storedAt < it->second.lifetime;
+    if (fresh) {
+        ++_statistics.hits;
+    }
+    return Entry{.data = std::move(*data), .etag = it->second.etag, .lastModified = it->second.lastModified, .fresh = fresh};
+}
+
+void UrlCache::store(std::string_view url, const ByteBuffer& data, std::string_view etag, std::string_view lastModified, std::optional<std::chrono::seconds> lifetime) {
+    if (data.size() > _options.maxBytes) {
+        return;
+    }
+    std::scoped_lock lock(_mutex);
+    const std::string key(url);
+    Record            record{.etag = std::string(etag), .lastModified = std::string(lastModified), .storedAt = secondsSinceEpoch(), .lifetime = lifetime.value_or(_options.freshFor).count(), .size = data.size(), .lastUsed = ++_clock};
+    if (!writeAtomically(pathOf(url, ".bin"), data) || !writeMeta(url, record)) {
+        std::println(stderr, "[UrlCache] could not store '{}' in '{}'", url, _options.directory.string());
+        erase(key);
+        return;
+    }
+    if (auto it = _index.find(key); it != _index.end()) {
+        _bytes -= it->second.size;
+    }
+    _index.insert_or_assign(key, std::move(record));
+    _bytes += data.size();
+    ++_statistics.stores;
+    evict();
+    persist();
+}
+
+void UrlCache::refresh(std::string_view url, std::optional<std::chrono::seconds> lifetime) {
+    std::scoped_lock lock(_mutex);
+    if (auto it = _index.find(std::string(url)); it != _index.end()) {
+        it->second.storedAt = secondsSinceEpoch();
+        it->second.lifetime = lifetime.value_or(_options.freshFor).count();
+        writeMeta(url, it->second);
+        ++_statistics.revalidated;
+        persist();
+    }
+}
+
+void UrlCache::clear() {
+    std::scoped_lock lock(_mutex);
+    while (!_index.empty()) {
+        erase(_index.begin()->first);
+    }
+    persist();
+}
+
+// N.B. expects '_mutex' to be held
+void UrlCache::erase(const std::string& url) {
+    std::error_code ec;
+    std::filesystem::remove(pathOf(url, ".bin"), ec); // existing memory mappings of the body stay valid
+    std::filesystem::remove(pathOf(url, ".meta"), ec);
+    if (auto it = _index.find(url); it != _index.end()) {
+        _bytes -= it->second.size;
+        _index.erase(it);
+    }
+}
+
+// N.B. expects '_mutex' to be held
+void UrlCache::evict() {
+    while (_bytes > _options.maxBytes && !_index.empty()) {
+        auto oldest = std::ranges::min_element(_index, {}, [](const auto& entry) { return entry.second.lastUsed; });
+        erase(std::string(oldest->first));
+        ++_statistics.evictions;
+    }
+}
+
+void UrlCache::persist() const {
+#ifdef __EMSCRIPTEN__
+    // debounced write-back of the IDBFS mount to IndexedDB (the browser side of FS.syncfs is asynchronous anyway)
+    MAIN_THREAD_ASYNC_EM_ASM({
+        if (Module.urlCacheSyncPending) {
+            return;
+        }
+        Module.urlCacheSyncPending = setTimeout(() => {
+            Module.urlCacheSyncPending = null;
+            FS.syncfs(false, (error) => {
+                if (error) {
+                    console.error("[UrlCache] could not persist the cache: ", error);
+                }
+            });
+        }, 1000);
+    });
+#endif
+}
+
+http::Headers UrlCache::conditionalHeaders(const Entry& entry) {
+    http::Headers headers;
+    if (!entry.etag.empty()) {
+        headers.emplace_back("If-None-Match", entry.etag);
+    }
+    if (!entry.lastModified.empty()) {
+        headers.emplace_back("If-Modified-Since", entry.lastModified);
+    }
+    return headers;
+}
+
+bool UrlCache::cacheable(std::string_view cacheControl) noexcept {
+    bool storable = true;
+    forEachDirective(cacheControl, [&](std::string_view name, std::string_view) { storable = storable && !equalsIgnoreCase(name, "no-store") && !equalsIgnoreCase(name, "private"); });
+    return storable;
+}
+
+std::optional<std::chrono::seconds> UrlCache::lifetimeOf(std::string_view cacheControl, std::string_view expires) {
+    bool                        noCache = false;
+    std::optional<std::int64_t> maxAge;
+    forEachDirective(cacheControl, [&](std::string_view name, std::string_view value) {
+        if (equalsIgnoreCase(name, "no-cache")) {
+            noCache = true;
+        } else if (equalsIgnoreCase(name, "max-age")) {
+            std::int64_t seconds = 0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+            maxAge                  = error == std::errc{} && end == value.data() + value.size() && seconds > 0 ? seconds : 0; // invalid -> stale
+        }
+    });
+    if (noCache) {
+        return std::chrono::seconds(0);
+    }
+    if (maxAge) {
+        return std::chrono::seconds(*maxAge);
+    }
+    if (!trim(expires).empty()) {
+        const std::optional<std::int64_t> expiresAt = parseHttpDate(expires);
+        return std::chrono::seconds(expiresAt ? std::max(*expiresAt - secondsSinceEpoch(), std::int64_t{0}) : 0); // e.g. "0": already expired
+    }
+    return std::nullopt;
+}
+
+UrlCache::Statistics UrlCache::statistics() const {
+    std::scoped_lock lock(_mutex);
+    Statistics       statistics = _statistics;
+    statistics.entries          = _index.size();
+    statistics.bytes            = _bytes;
+    return statistics;
+}
+
+} // namespace file
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <print>
+#include <span>
+#include <string_view>
+#include <unordered_set>
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <write_behind.hpp>
+
+namespace file {
+
+namespace {
+using Status = std::expected<void, std::string>;
+
+std::string temporaryOf(std::string_view path) { return std::format("{}.tmp", path); }
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+std::string errorOf(std::string_view what, std::string_view path) { return std::format("{} '{}': {}", what, path, std::strerror(errno)); }
+
+// returns the open descriptor (for a later sync), the data is written with positional writes straight from 'data'
+std::expected<int, std::string> writeTemporary(const std::string& temporary, std::span<const std::uint8_t> data) {
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(errorOf("could not create", temporary));
+    }
+    for (std::size_t offset = 0UZ; offset < data.size();) {
+        const ssize_t n = ::pwrite(fd, data.data() + offset, data.size() - offset, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            std::string error = errorOf("could not write", temporary);
+            ::close(fd);
+            ::unlink(temporary.c_str());
+            return std::unexpected(std::move(error));
+        }
+        offset += static_cast<std::size_t>(n);
+    }
+#if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+    ::sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE); // start write-back now, overlapping the next files of the batch
+#endif
+    return fd;
+}
+
+bool syncData(int fd) {
+#if defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+// optionally syncs, then closes the temporary file and renames it over 'path' (removing it on failure), 'syncs' counts the syncs issued
+Status commitTemporary(const std::string& path, int fd, bool sync, std::size_t& syncs) {
+    const std::string temporary = temporaryOf(path);
+    std::string       error;
+    if (sync) {
+        ++syncs;
+        if (!syncData(fd)) {
+            error = errorOf("could not sync", temporary);
+        }
+    }
+    ::close(fd);
+    if (error.empty() && ::rename(temporary.c_str(), path.c_str()) != 0) {
+        error = errorOf("could not rename to", path);
+    }
+    if (!error.empty()) {
+        ::unlink(temporary.c_str());
+        return std::unexpected(std::move(error));
+    }
+    return {};
+}
+
+// makes the renames into 'directory' durable, 'syncs' counts the syncs issued
+Status syncDirectory(const std::filesystem::path& directory, std::size_t& syncs) {
+    const std::string path = directory.empty() ? std::string(".") : directory.string();
+    const int         fd   = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(errorOf("could not open directory", path));
+    }
+    ++syncs;
+    Status status;
+    if (::fsync(fd) != 0) {
+        status = std::unexpected(errorOf("could not sync directory", path));
+    }
+    ::close(fd);
+    return status;
+}
+#endif
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+// writes per batch that may hold an open descriptor at the same time, leaves the rest of the soft limit to the application
+std::size_t openFileBudget() noexcept {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+        return SIZE_MAX;
+    }
+    return std::max(static_cast<std::size_t>(limit.rlim_cur / 4U), 1UZ);
+}
+#else
+std::size_t openFileBudget() noexcept { return SIZE_MAX; } // files are closed before the next one is opened
+#endif
+} // namespace
+
+WriteBehind::WriteBehind(Options options) : _options(options), _worker(&WriteBehind::run, this) {}
+
+WriteBehind::~WriteBehind() noexcept {
+    {
+        std::scoped_lock lock(_mutex);
+        _stopping = true;
+    }
+    _workAvailable.notify_all();
+    _worker.join();
+}
+
+void WriteBehind::enqueue(std::string path, ByteBuffer data) {
+    {
+        std::scoped_lock lock(_mutex);
+        _queue.push_back(Write{std::move(path), std::move(data), Clock::now()});
+        ++_enqueued;
+    }
+    _workAvailable.notify_one();
+}
+
+void WriteBehind::flush() {
+    std::unique_lock lock(_mutex);
+    const std::uint64_t target = _enqueued;
+    _batchWritten.wait(lock, [this, target] { return _done >= target; });
+}
+
+void WriteBehind::setOptions(Options options) {
+    std::scoped_lock lock(_mutex);
+    _options = options;
+}
+
+WriteBehind::Statistics WriteBehind::statistics() const {
+    std::scoped_lock lock(_mutex);
+    Statistics       statistics = _statistics;
+    statistics.pending          = _queue.size();
+    if (statistics.writes > 0UZ) {
+        statistics.meanLatency = std::chrono::duration_cast<std::chrono::nanoseconds>(_totalLatency / statistics.writes);
+    }
+    if (const double seconds = std::chrono::duration<double>(_busy).count(); seconds > 0.0) {
+        statistics.bytesPerSecond = static_cast<double>(statistics.bytes) / seconds;
+    }
+    return statistics;
+}
+
+void WriteBehind::run() {
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _workAvailable.wait(lock, [this] { return _stopping || !_queue.empty(); });
+        if (_queue.empty()) {
+            return; // stopping and drained
+        }
+        std::vector<Write> batch;
+        std::size_t        bytes    = 0UZ;
+        const std::size_t  maxFiles = std::clamp(_options.maxBatchFiles, 1UZ, openFileBudget()); // N.B. no EMFILE for many small writes
+        while (!_queue.empty() && batch.size() < maxFiles && (batch.empty() || bytes + _queue.front().data.size() <= _options.maxBatchBytes)) {
+            bytes += _queue.front().data.size();
+            batch.push_back(std::move(_queue.front()));
+            _queue.pop_front();
+        }
+        const Durability durability = _options.durability;
+        lock.unlock();
+
+        writeBatch(batch, durability);
+
+        lock.lock();
+        _done += batch.size();
+        _batchWritten.notify_all();
+    }
+}
+
+void WriteBehind::writeBatch(std::vector<Write>& batch, Durability durability) {
+    const Clock::time_point start = Clock::now();
+
+    // last write of each path wins, the others are dropped without touching the disk
+    std::vector<Write*>                  writes;
+    std::unordered_set<std::string_view> seen;
+    for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+        if (seen.insert(it->path).second) {
+            writes.push_back(&*it);
+        }
+    }
+    std::ranges::reverse(writes);
+    const std::size_t coalesced = batch.size() - writes.size();
+
+    struct Outcome {
+        Write*            write;
+        Status            status;
+        Clock::time_point finished;
+    };
+    std::vector<Outcome> outcomes;
+    outcomes.reserve(writes.size());
+    std::size_t syncs = 0UZ;
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+    std::vector<std::pair<Write*, int>> staged; // Batched: written and open, synced and renamed together below
+    for (Write* write : writes) {
+        auto fd = writeTemporary(temporaryOf(write->path), write->data);
+        if (!fd) {
+            outcomes.push_back({write, std::unexpected(std::move(fd.error())), Clock::now()});
+            continue;
+        }
+        if (durability == Durability::Batched) {
+            staged.emplace_back(write, *fd);
+            continue;
+        }
+        Status status = commitTemporary(write->path, *fd, durability == Durability::EveryWrite, syncs);
+        if (status && durability == Durability::EveryWrite) { // renamed but not durable if the directory sync fails
+            status = syncDirectory(std::filesystem::path(write->path).parent_path(), syncs);
+        }
+        outcomes.push_back({write, std::move(status), Clock::now()});
+    }
+
+    if (!staged.empty()) {
+        std::vector<std::filesystem::path> directories;
+        for (auto& [write, fd] : staged) { // mostly waits for the write-back started by writeTemporary()
+            Status status = commitTemporary(write->path, fd, true, syncs);
+            if (auto directory = std::filesystem::path(write->path).parent_path(); status && std::ranges::find(directories, directory) == directories.end()) {
+                directories.push_back(std::move(directory));
+            }
+            outcomes.push_back({write, std::move(status), Clock::now()});
+        }
+        for (const auto& directory : directories) { // makes the renames durable, once per directory and batch
+            if (Status synced = syncDirectory(directory, syncs); !synced) { // fails the batch's files renamed into it
+                for (Outcome& outcome : outcomes) {
+                    if (outcome.status && std::filesystem::path(outcome.write->path).parent_path() == directory) {
+                        outcome.status = std::unexpected(std::format("{} (after writing '{}')", synced.error(), outcome.write->path));
+                    }
+                }
+            }
+        }
+        const Clock::time_point synced = Clock::now(); // the batch becomes durable as a whole
+        for (Outcome& outcome : outcomes) {
+            outcome.finished = outcome.status ? synced : outcome.finished;
+        }
+    }
+#else
+    for (Write* write : writes) { // no POSIX I/O: stream into the temporary file, rename without syncing
+        const std::string temporary = temporaryOf(write->path);
+        bool              ok        = false;
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            ok = static_cast<bool>(out.write(reinterpret_cast<const char*>(write->data.data()), static_cast<std::streamsize>(write->data.size())));
+        }
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(temporary, write->path, ec);
+        }
+        if (!ok || ec) {
+            std::filesystem::remove(temporary, ec);
+            outcomes.push_back({write, std::unexpected(std::format("could not write '{}'", write->path)), Clock::now()});
+        } else {
+            outcomes.push_back({write, Status{}, Clock::now()});
+        }
+    }
+#endif
+
+    const Clock::time_point end = Clock::now();
+    std::scoped_lock        lock(_mutex);
+    _busy += end - start;
+    ++_statistics.batches;
+    _statistics.coalesced += coalesced;
+    _statistics.syncs += syncs;
+    for (const Outcome& outcome : outcomes) {
+        if (!outcome.status) {
+            ++_statistics.failed;
+            std::println(stderr, "[WriteBehind] {}", outcome.status.error());
+            continue;
+        }
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(outcome.finished - outcome.write->enqueued);
+        ++_statistics.writes;
+        _statistics.bytes += outcome.write->data.size();
+        _statistics.lastLatency = latency;
+        _statistics.maxLatency  = std::max(_statistics.maxLatency, latency);
+        _totalLatency += latency;
+    }
+}
+
+} // namespace file
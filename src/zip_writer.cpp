@@ -0,0 +1,378 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <print>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <zip_writer.hpp>
+
+namespace file {
+
+namespace {
+constexpr std::uint32_t kLocalHeaderSignature   = 0x04034b50U;
+constexpr std::uint32_t kDataDescriptorSignature = 0x08074b50U;
+constexpr std::uint32_t kCentralHeaderSignature  = 0x02014b50U;
+constexpr std::uint32_t kEndOfDirectorySignature = 0x06054b50U;
+constexpr std::uint16_t kVersionNeeded           = 20U;      // 2.0: deflate, data descriptors
+constexpr std::uint16_t kFlagDataDescriptor      = 1U << 3U; // crc/sizes follow the data (compressed size unknown up front)
+constexpr std::uint16_t kFlagUtf8                = 1U << 11U;
+constexpr std::uint64_t kMaxField32              = 0xFFFF'FFFFU; // beyond: ZIP64 would be required
+constexpr std::uint64_t kMaxField16              = 0xFFFFU;
+
+void append16(std::vector<std::uint8_t>& out, std::uint16_t value) {
+    out.push_back(static_cast<std::uint8_t>(value));
+    out.push_back(static_cast<std::uint8_t>(value >> 8U));
+}
+
+void append32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    append16(out, static_cast<std::uint16_t>(value));
+    append16(out, static_cast<std::uint16_t>(value >> 16U));
+}
+
+#ifdef HAVE_ZLIB
+std::uint32_t crc32(std::span<const std::uint8_t> data) {
+    uLong crc = ::crc32(0UL, Z_NULL, 0U);
+    for (std::size_t offset = 0UZ; offset < data.size();) {
+        const std::size_t n = std::min<std::size_t>(data.size() - offset, UINT_MAX);
+        crc                 = ::crc32(crc, data.data() + offset, static_cast<uInt>(n));
+        offset += n;
+    }
+    return static_cast<std::uint32_t>(crc);
+}
+#else
+constexpr std::array<std::uint32_t, 256UZ> kCrcTable = [] {
+    std::array<std::uint32_t, 256UZ> table{};
+    for (std::uint32_t i = 0U; i < table.size(); ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+std::uint32_t crc32(std::span<const std::uint8_t> data) {
+    std::uint32_t crc = 0xFFFF'FFFFU;
+    for (const std::uint8_t byte : data) {
+        crc = kCrcTable[(crc ^ byte) & 0xFFU] ^ (crc >> 8U);
+    }
+    return crc ^ 0xFFFF'FFFFU;
+}
+#endif
+} // namespace
+
+ZipWriter::ZipWriter(Sink sink, std::function<void(bool)> onFinish, Method method, std::size_t chunkSize) : _sink(std::move(sink)), _onFinish(std::move(onFinish)), _method(hasDeflate() ? method : Method::Store), _chunkSize(std::clamp(chunkSize, 1UZ << 10, 1UZ << 30)) {
+    if (method == Method::Deflate && !hasDeflate()) {
+        std::println(stderr, "[ZipWriter] built without zlib - storing entries uncompressed");
+    }
+    _buffer.reserve(_chunkSize);
+
+    // entry timestamps in MS-DOS format (2 s resolution, UTC)
+    using namespace std::chrono;
+    const auto              now = system_clock::now();
+    const auto              day = floor<days>(now);
+    const year_month_day    date{day};
+    const hh_mm_ss<seconds> time{floor<seconds>(now - day)};
+    _dosTime = static_cast<std::uint16_t>((time.hours().count() << 11) | (time.minutes().count() << 5) | (time.seconds().count() / 2));
+    _dosDate = static_cast<std::uint16_t>((std::max(static_cast<int>(date.year()) - 1980, 0) << 9) | (static_cast<unsigned>(date.month()) << 5) | static_cast<unsigned>(date.day()));
+}
+
+ZipWriter::ZipWriter(std::string_view path, Method method, std::size_t chunkSize) : ZipWriter(nullptr, nullptr, method, chunkSize) {
+#ifdef __EMSCRIPTEN__
+    // chunks are collected as Blob parts on the main thread (the owner of the document) and downloaded at once by finish()
+    static std::atomic<int> nextArchiveID{0};
+    const int               archiveID = nextArchiveID.fetch_add(1, std::memory_order_relaxed);
+    MAIN_THREAD_EM_ASM(
+        {
+            Module.zipWriterParts     = Module.zipWriterParts || {};
+            Module.zipWriterParts[$0] = [];
+        },
+        archiveID);
+    _sink = [archiveID](std::span<const std::uint8_t> bytes) {
+        MAIN_THREAD_EM_ASM({ Module.zipWriterParts[$0].push(HEAPU8.slice($1, $1 + $2)); }, archiveID, bytes.data(), static_cast<int>(bytes.size()));
+        return true;
+    };
+    _onFinish = [archiveID, name = std::string(path)](bool ok) {
+        MAIN_THREAD_EM_ASM(
+            {
+                const parts = Module.zipWriterParts[$0];
+                delete Module.zipWriterParts[$0];
+                if (!$2) {
+                    return;
+                }
+                const link    = document.createElement('a');
+                link.href     = URL.createObjectURL(new Blob(parts, {type: 'application/zip'}));
+                link.download = UTF8ToString($1);
+                document.body.appendChild(link);
+                try {
+                    link.click();
+                } catch (e) {
+                    console.error("[EM_ASM] ZipWriter::finish() - link.click() failed: ", e);
+                }
+                document.body.removeChild(link);
+                URL.revokeObjectURL(link.href);
+            },
+            archiveID, name.c_str(), ok ? 1 : 0);
+    };
+#else
+    auto out = std::make_shared<std::ofstream>(std::string(path), std::ios::binary | std::ios::trunc);
+    if (!*out) {
+        _error = std::format("could not open '{}' for writing", path);
+    }
+    _sink = [out](std::span<const std::uint8_t> bytes) {
+        out->write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(*out);
+    };
+    _onFinish = [this, out, name = std::string(path)](bool ok) {
+        out->close();
+        if (!ok || !*out) {
+            std::error_code ec;
+            std::filesystem::remove(name, ec); // no truncated archives
+            return;
+        }
+        std::println("[ZipWriter] archive written: {} ({} entries, {} bytes)", name, _entries.size(), _flushed);
+    };
+#endif
+}
+
+ZipWriter::~ZipWriter() noexcept {
+    if (auto status = finish(); !status) {
+        std::println(stderr, "[ZipWriter] {}", status.error());
+    }
+}
+
+bool ZipWriter::hasDeflate() noexcept {
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::size_t ZipWriter::entries() const {
+    std::scoped_lock lock(_mutex);
+    return _entries.size();
+}
+
+std::uint64_t ZipWriter::bytesWritten() const {
+    std::scoped_lock lock(_mutex);
+    return _flushed;
+}
+
+bool ZipWriter::flush() {
+    if (_buffer.empty() || !_error.empty()) {
+        return _error.empty();
+    }
+    if (!_sink(_buffer)) {
+        _error = "archive write failed";
+        return false;
+    }
+    _flushed += _buffer.size();
+    _buffer.clear();
+    return true;
+}
+
+void ZipWriter::put(std::span<const std::uint8_t> bytes) {
+    _offset += bytes.size();
+    if (_buffer.size() + bytes.size() <= _chunkSize) {
+        _buffer.insert(_buffer.end(), bytes.begin(), bytes.end());
+        if (_buffer.size() == _chunkSize) {
+            flush();
+        }
+        return;
+    }
+    if (!flush()) {
+        return;
+    }
+    if (bytes.size() < _chunkSize) {
+        _buffer.insert(_buffer.end(), bytes.begin(), bytes.end());
+        return;
+    }
+    // large payloads bypass the buffer: sink them directly in chunk-sized slices
+    for (std::size_t offset = 0UZ; offset < bytes.size(); offset += _chunkSize) {
+        const auto slice = bytes.subspan(offset, std::min(_chunkSize, bytes.size() - offset));
+        if (!_sink(slice)) {
+            _error = "archive write failed";
+            return;
+        }
+        _flushed += slice.size();
+    }
+}
+
+ZipWriter::Status ZipWriter::putDeflated([[maybe_unused]] std::span<const std::uint8_t> data, [[maybe_unused]] std::uint32_t& compressedSize) {
+#ifdef HAVE_ZLIB
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) { // raw deflate as required by ZIP
+        return std::unexpected("deflateInit2 failed");
+    }
+    std::size_t   consumed = 0UZ;
+    std::uint64_t produced = 0U;
+    int           rc       = Z_OK;
+    while (rc != Z_STREAM_END && _error.empty()) {
+        if (stream.avail_in == 0U && consumed < data.size()) {
+            const std::size_t n = std::min<std::size_t>(data.size() - consumed, UINT_MAX);
+            stream.next_in      = const_cast<Bytef*>(data.data() + consumed);
+            stream.avail_in     = static_cast<uInt>(n);
+            consumed += n;
+        }
+        if (_buffer.size() == _chunkSize && !flush()) {
+            break;
+        }
+        // compress straight into the spare room of the output buffer
+        const std::size_t used = _buffer.size();
+        _buffer.resize(_chunkSize);
+        stream.next_out  = _buffer.data() + used;
+        stream.avail_out = static_cast<uInt>(_chunkSize - used);
+        rc               = ::deflate(&stream, consumed == data.size() ? Z_FINISH : Z_NO_FLUSH);
+        const std::size_t written = _chunkSize - used - stream.avail_out;
+        _buffer.resize(used + written);
+        _offset += written;
+        produced += written;
+        if (rc == Z_STREAM_ERROR) {
+            _error = "deflate failed";
+        }
+    }
+    deflateEnd(&stream);
+    if (!_error.empty()) {
+        return std::unexpected(_error);
+    }
+    if (produced > kMaxField32) {
+        return std::unexpected("compressed entry exceeds 4 GiB (ZIP64 is not supported)");
+    }
+    compressedSize = static_cast<std::uint32_t>(produced);
+    return {};
+#else
+    return std::unexpected("built without zlib");
+#endif
+}
+
+ZipWriter::Status ZipWriter::add(std::string_view name, std::span<const std::uint8_t> data) {
+    std::scoped_lock lock(_mutex);
+    if (_finished) {
+        return std::unexpected(std::format("cannot add '{}': archive already finished", name));
+    }
+    if (!_error.empty()) {
+        return std::unexpected(_error);
+    }
+    if (name.empty() || name.size() > kMaxField16) {
+        return std::unexpected(std::format("invalid entry name '{}'", name));
+    }
+    if (_entries.size() >= kMaxField16 || data.size() > kMaxField32 || _offset > kMaxField32) {
+        return std::unexpected(std::format("cannot add '{}': archive exceeds 65535 entries or 4 GiB (ZIP64 is not supported)", name));
+    }
+
+    const bool deflated = _method == Method::Deflate && !data.empty();
+    Entry      entry{.name           = std::string(name),
+                     .crc            = crc32(data),
+                     .compressedSize = static_cast<std::uint32_t>(data.size()),
+                     .size           = static_cast<std::uint32_t>(data.size()),
+                     .offset         = static_cast<std::uint32_t>(_offset),
+                     .method         = static_cast<std::uint16_t>(deflated ? Method::Deflate : Method::Store),
+                     .flags          = static_cast<std::uint16_t>(kFlagUtf8 | (deflated ? kFlagDataDescriptor : 0U))};
+
+    std::vector<std::uint8_t> header;
+    header.reserve(30UZ + name.size());
+    append32(header, kLocalHeaderSignature);
+    append16(header, kVersionNeeded);
+    append16(header, entry.flags);
+    append16(header, entry.method);
+    append16(header, _dosTime);
+    append16(header, _dosDate);
+    append32(header, deflated ? 0U : entry.crc); // with a data descriptor these are zero here
+    append32(header, deflated ? 0U : entry.compressedSize);
+    append32(header, deflated ? 0U : entry.size);
+    append16(header, static_cast<std::uint16_t>(name.size()));
+    append16(header, 0U); // extra field length
+    header.insert(header.end(), name.begin(), name.end());
+    put(header);
+
+    if (deflated) {
+        if (auto status = putDeflated(data, entry.compressedSize); !status) {
+            _error = status.error(); // the archive is corrupt from here on
+            return status;
+        }
+        header.clear();
+        append32(header, kDataDescriptorSignature);
+        append32(header, entry.crc);
+        append32(header, entry.compressedSize);
+        append32(header, entry.size);
+        put(header);
+    } else {
+        put(data);
+    }
+    if (!_error.empty()) {
+        return std::unexpected(_error);
+    }
+    _entries.push_back(std::move(entry));
+    return {};
+}
+
+ZipWriter::Status ZipWriter::finish() {
+    std::scoped_lock lock(_mutex);
+    if (_finished) {
+        return _error.empty() ? Status{} : std::unexpected(_error);
+    }
+    _finished = true;
+
+    const std::uint64_t       directoryOffset = _offset;
+    std::vector<std::uint8_t> record;
+    for (const Entry& entry : _entries) {
+        record.clear();
+        append32(record, kCentralHeaderSignature);
+        append16(record, kVersionNeeded); // version made by (MS-DOS attributes)
+        append16(record, kVersionNeeded);
+        append16(record, entry.flags);
+        append16(record, entry.method);
+        append16(record, _dosTime);
+        append16(record, _dosDate);
+        append32(record, entry.crc);
+        append32(record, entry.compressedSize);
+        append32(record, entry.size);
+        append16(record, static_cast<std::uint16_t>(entry.name.size()));
+        append16(record, 0U); // extra field length
+        append16(record, 0U); // comment length
+        append16(record, 0U); // disk number
+        append16(record, 0U); // internal attributes
+        append32(record, 0U); // external attributes
+        append32(record, entry.offset);
+        record.insert(record.end(), entry.name.begin(), entry.name.end());
+        put(record);
+    }
+    const std::uint64_t directorySize = _offset - directoryOffset;
+    if (directoryOffset > kMaxField32 || directorySize > kMaxField32) {
+        _error = "archive exceeds 4 GiB (ZIP64 is not supported)";
+    }
+
+    record.clear();
+    append32(record, kEndOfDirectorySignature);
+    append16(record, 0U); // this disk
+    append16(record, 0U); // disk with the central directory
+    append16(record, static_cast<std::uint16_t>(_entries.size()));
+    append16(record, static_cast<std::uint16_t>(_entries.size()));
+    append32(record, static_cast<std::uint32_t>(directorySize));
+    append32(record, static_cast<std::uint32_t>(directoryOffset));
+    append16(record, 0U); // comment length
+    put(record);
+    flush();
+
+    if (_onFinish) {
+        _onFinish(_error.empty());
+    }
+    return _error.empty() ? Status{} : std::unexpected(_error);
+}
+
+} // namespace file
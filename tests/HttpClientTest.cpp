@@ -0,0 +1,179 @@
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <mutex>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <http_client.hpp>
+
+#include "TestUtils.hpp"
+
+// http::Client against a scripted HTTP/1.1 server on a loopback port opened by the test itself (no network access needed).
+// Usage: HttpClientTest (exit code 0: all checks passed)
+
+namespace {
+
+using test::expect;
+
+std::string_view bodyOf(const http::Response& response) { return {reinterpret_cast<const char*>(response.body.data()), response.body.size()}; }
+
+/// answers keep-alive requests per path: /plain, /chunked, /redirect (-> /plain), /continue (interim 100 + /plain), anything else 404
+class LoopbackServer {
+    int                      _listener = -1;
+    std::uint16_t            _port     = 0U;
+    std::atomic<int>         _accepted{0};
+    std::thread              _acceptor;
+    std::mutex               _mutex;
+    std::vector<std::thread> _connections;
+    std::vector<int>         _sockets;
+
+    static bool sendAll(int fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+        return true;
+    }
+
+    static std::string respond(std::string_view target) {
+        if (target == "/plain") {
+            return "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nContent-Type: text/plain\r\n\r\nhello";
+        }
+        if (target == "/chunked") {
+            return "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nhel\r\n8;ext=1\r\nlo world\r\n0\r\nX-Trailer: 1\r\n\r\n";
+        }
+        if (target == "/continue") {
+            return "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 102 Processing\r\nX-Interim: 1\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+        }
+        if (target == "/redirect") {
+            return "HTTP/1.1 302 Found\r\nLocation: /plain\r\nContent-Length: 0\r\n\r\n";
+        }
+        return "HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found";
+    }
+
+    void serve(int fd) {
+        std::string pending;
+        char        buffer[4096];
+        while (true) {
+            const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                return; // client closed the connection
+            }
+            pending.append(buffer, static_cast<std::size_t>(n));
+            for (std::size_t end; (end = pending.find("\r\n\r\n")) != std::string::npos; pending.erase(0UZ, end + 4UZ)) {
+                const std::size_t targetBegin = pending.find(' ') + 1UZ;
+                const std::string target      = pending.substr(targetBegin, pending.find(' ', targetBegin) - targetBegin);
+                if (!sendAll(fd, respond(target))) {
+                    return;
+                }
+            }
+        }
+    }
+
+public:
+    LoopbackServer() {
+        _listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port        = 0U; // ephemeral
+        socklen_t length        = sizeof(address);
+        if (::bind(_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(_listener, 16) != 0 || ::getsockname(_listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            std::println(stderr, "could not open a loopback listener: {}", std::strerror(errno));
+            return;
+        }
+        _port     = ntohs(address.sin_port);
+        _acceptor = std::thread([this] {
+            while (true) {
+                const int fd = ::accept(_listener, nullptr, nullptr);
+                if (fd < 0) {
+                    return; // listener shut down
+                }
+                ++_accepted;
+                std::scoped_lock lock(_mutex);
+                _sockets.push_back(fd);
+                _connections.emplace_back([this, fd] { serve(fd); });
+            }
+        });
+    }
+
+    ~LoopbackServer() {
+        ::shutdown(_listener, SHUT_RDWR);
+        ::close(_listener);
+        if (_acceptor.joinable()) {
+            _acceptor.join();
+        }
+        std::scoped_lock lock(_mutex);
+        for (const int fd : _sockets) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        for (std::thread& connection : _connections) {
+            connection.join();
+        }
+        for (const int fd : _sockets) {
+            ::close(fd);
+        }
+    }
+
+    [[nodiscard]] bool        ok() const noexcept { return _port != 0U; }
+    [[nodiscard]] int         accepted() const noexcept { return _accepted.load(); }
+    [[nodiscard]] std::string url(std::string_view path) const { return std::format("http://127.0.0.1:{}{}", _port, path); }
+};
+
+} // namespace
+
+int main() {
+    LoopbackServer server;
+    if (!server.ok()) {
+        return 1;
+    }
+    {
+        http::Client client;
+
+        auto plain = client.get(server.url("/plain"));
+        expect(plain.has_value(), "plain GET succeeds");
+        if (plain) {
+            expect(plain->status == 200, "plain GET status 200");
+            expect(bodyOf(*plain) == "hello", "plain GET body");
+            expect(plain->header("content-type") == "text/plain", "headers are looked up by lower-case name");
+        }
+
+        auto again = client.get(server.url("/plain"));
+        expect(again.has_value() && bodyOf(*again) == "hello", "second GET succeeds");
+        expect(client.statistics().connectionsReused >= 1UZ, "second GET reuses the keep-alive connection");
+        expect(server.accepted() == 1, "a single TCP connection for sequential requests");
+
+        auto chunked = client.get(server.url("/chunked"));
+        expect(chunked.has_value() && chunked->status == 200, "chunked GET succeeds");
+        expect(chunked && bodyOf(*chunked) == "hello world", "chunked body is reassembled (chunk extensions and trailers skipped)");
+
+        auto redirected = client.get(server.url("/redirect"));
+        expect(redirected.has_value() && redirected->status == 200, "redirect is followed");
+        expect(redirected && bodyOf(*redirected) == "hello", "redirect target body");
+
+        auto interim = client.get(server.url("/continue"));
+        expect(interim.has_value() && interim->status == 200, "interim 1xx responses are skipped");
+        expect(interim && bodyOf(*interim) == "hello" && interim->header("x-interim").empty(), "final response body and headers only");
+
+        auto missing = client.get(server.url("/missing"));
+        expect(missing.has_value(), "error status is a response, not a transport error");
+        expect(missing && missing->status == 404 && bodyOf(*missing) == "not found", "404 status and body");
+
+        expect(server.accepted() == 1, "all requests share one keep-alive connection");
+        expect(!client.get("https://127.0.0.1/").has_value(), "https is rejected");
+    } // closes the pooled connections before the server stops
+
+    return test::report("HttpClientTest");
+}
@@ -0,0 +1,33 @@
+#ifndef TEST_UTILS_HPP
+#define TEST_UTILS_HPP
+
+#include <print>
+#include <source_location>
+#include <string_view>
+
+// minimal check harness shared by the native tests: failed checks are reported with their location, report() sets the exit code
+
+namespace test {
+
+inline int g_failures = 0;
+
+inline void expect(bool condition, std::string_view what, std::source_location where = std::source_location::current()) {
+    if (!condition) {
+        std::println(stderr, "FAILED {}:{}: {}", where.file_name(), where.line(), what);
+        ++g_failures;
+    }
+}
+
+/// exit code of the test's main(): 0 if all checks passed
+inline int report(std::string_view testName) {
+    if (g_failures != 0) {
+        std::println(stderr, "{} check(s) failed", g_failures);
+        return 1;
+    }
+    std::println("{}: all checks passed", testName);
+    return 0;
+}
+
+} // namespace test
+
+#endif // TEST_UTILS_HPP
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <ByteBuffer.hpp>
+#include <file_io.hpp>
+
+#include "TestUtils.hpp"
+
+// file::parseUploadedFiles on buffers in the upload wire format (as written by the browser's file picker, see file_io.cpp)
+// Usage: UploadParseTest (exit code 0: all checks passed)
+
+namespace {
+
+using test::expect;
+
+void appendUint32(std::vector<std::uint8_t>& out, std::uint32_t value) { // little-endian like the JS DataView writer
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+}
+
+std::vector<std::uint8_t> encode(const std::vector<std::pair<std::string, std::string>>& files) {
+    std::vector<std::uint8_t> out;
+    appendUint32(out, static_cast<std::uint32_t>(files.size()));
+    for (const auto& [name, data] : files) {
+        appendUint32(out, static_cast<std::uint32_t>(name.size()));
+        appendUint32(out, static_cast<std::uint32_t>(data.size()));
+        out.insert(out.end(), name.begin(), name.end());
+        out.insert(out.end(), data.begin(), data.end());
+    }
+    return out;
+}
+
+std::string_view bytesOf(const ByteBuffer& buffer) { return {reinterpret_cast<const char*>(buffer.data()), buffer.size()}; }
+
+template<typename Fn>
+bool throwsRuntimeError(Fn&& fn) {
+    try {
+        std::forward<Fn>(fn)();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<std::pair<std::string, std::string>> input{
+        {"a.txt", "first file"},
+        {"empty.bin", ""},
+        {"\xc3\xbc-utf8.ogg", std::string("\x00\x01\x02\xff", 4UZ)},
+    };
+    const std::vector<std::uint8_t> encoded = encode(input);
+
+    { // multi-file buffer: names and bytes, payloads are slices of the upload buffer
+        const ByteBuffer buffer{std::vector<std::uint8_t>(encoded)};
+        auto             files = file::parseUploadedFiles(42UZ, buffer);
+        expect(files.size() == input.size(), "one FileData per encoded file");
+        for (std::size_t i = 0UZ; i < std::min(files.size(), input.size()); ++i) {
+            expect(files[i].requestID == 42UZ, "requestID is propagated");
+            expect(files[i].name == input[i].first, "file name");
+            expect(bytesOf(files[i].data) == input[i].second, "file bytes");
+            if (!files[i].data.empty()) {
+                expect(files[i].data.data() >= buffer.data() && files[i].data.end() <= buffer.end(), "payload points into the upload buffer (no copy)");
+            }
+        }
+        expect(buffer.useCount() == 1L + static_cast<long>(files.size()), "every slice holds a reference to the upload buffer");
+        files.clear();
+        expect(buffer.useCount() == 1L, "releasing the slices drops their references");
+    }
+
+    { // empty upload
+        const ByteBuffer buffer{encode({})};
+        expect(file::parseUploadedFiles(1UZ, buffer).empty(), "zero files");
+    }
+
+    { // truncated header/payload: every prefix of the encoded buffer must be rejected
+        for (std::size_t length = 0UZ; length < encoded.size(); ++length) {
+            const ByteBuffer truncated{std::vector<std::uint8_t>(encoded.begin(), encoded.begin() + static_cast<std::ptrdiff_t>(length))};
+            expect(throwsRuntimeError([&] { (void)file::parseUploadedFiles(1UZ, truncated); }), "truncated buffer throws");
+        }
+    }
+
+    { // lengths in a header that exceed the buffer (corrupt or hostile input)
+        std::vector<std::uint8_t> corrupt;
+        appendUint32(corrupt, 1U);
+        appendUint32(corrupt, 4U);
+        appendUint32(corrupt, 0xffff'fff0U);
+        corrupt.insert(corrupt.end(), {'n', 'a', 'm', 'e', 'x'});
+        expect(throwsRuntimeError([&] { (void)file::parseUploadedFiles(1UZ, ByteBuffer(std::move(corrupt))); }), "oversized data length throws");
+
+        std::vector<std::uint8_t> manyFiles;
+        appendUint32(manyFiles, 0xffff'ffffU);
+        expect(throwsRuntimeError([&] { (void)file::parseUploadedFiles(1UZ, ByteBuffer(std::move(manyFiles))); }), "oversized file count throws");
+    }
+
+    return test::report("UploadParseTest");
+}